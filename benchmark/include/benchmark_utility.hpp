@@ -99,13 +99,32 @@ std::vector<T> generateFewUniqueVector(size_t size, size_t num_unique = 10) {
   return vec;
 }
 
+// Values sharing their high bits, like timestamps or IDs with a common prefix
+template <typename T>
+std::vector<T> generateNarrowRangeVector(size_t size, size_t range_bit = 20) {
+  auto vec = generateRandomVector<T>(size);
+
+  if constexpr (std::is_integral_v<T>) {
+    if (range_bit < sizeof(T) * 8) {
+      const T base = generateRandomVector<T>(1)[0];
+      const T mask = static_cast<T>((T(1) << range_bit) - 1);
+      for (T &val : vec) {
+        val = static_cast<T>((base & ~mask) | (val & mask));
+      }
+    }
+  }
+
+  return vec;
+}
+
 // Enum for different data distributions
 enum class DataDistribution {
   Random,
   Sorted,
   ReverseSorted,
   NearlySorted,
-  FewUnique
+  FewUnique,
+  NarrowRange
 };
 
 // Function to generate data based on distribution type
@@ -122,6 +141,8 @@ std::vector<T> generateData(size_t size, DataDistribution distribution) {
     return generateNearlySortedVector<T>(size);
   case DataDistribution::FewUnique:
     return generateFewUniqueVector<T>(size);
+  case DataDistribution::NarrowRange:
+    return generateNarrowRangeVector<T>(size);
   default:
     return generateRandomVector<T>(size);
   }
@@ -140,6 +161,8 @@ inline std::string getDistributionName(DataDistribution distribution) {
     return "Nearly Sorted";
   case DataDistribution::FewUnique:
     return "Few Unique";
+  case DataDistribution::NarrowRange:
+    return "Narrow Range";
   default:
     return "Unknown";
   }
@@ -200,14 +223,16 @@ void runBenchmark(const std::string &algorithm_name, SortFunc sortFunc,
   std::cout << std::endl;
 }
 
-// Function to compare multiple sorting algorithms
+// Function to compare multiple sorting algorithms on data made by generate
 template <typename T>
 void compareSortingAlgorithms(
     const std::vector<
         std::pair<std::string, std::function<void(std::vector<T> &)>>>
         &algorithms,
     const std::vector<size_t> &sizes,
-    const std::vector<DataDistribution> &distributions, size_t num_runs = 5) {
+    const std::vector<DataDistribution> &distributions,
+    const std::function<std::vector<T>(size_t, DataDistribution)> &generate,
+    size_t num_runs = 5) {
 
   std::cout << "===== Comparing Sorting Algorithms with " << typeid(T).name()
             << " =====" << std::endl;
@@ -232,7 +257,7 @@ void compareSortingAlgorithms(
 
         // Run multiple times and take average
         for (size_t run = 0; run < num_runs; ++run) {
-          auto data = generateData<T>(size, dist);
+          auto data = generate(size, dist);
           total_time += measureSortPerformance(func, data);
         }
 
@@ -248,4 +273,16 @@ void compareSortingAlgorithms(
   }
 }
 
+// Function to compare multiple sorting algorithms
+template <typename T>
+void compareSortingAlgorithms(
+    const std::vector<
+        std::pair<std::string, std::function<void(std::vector<T> &)>>>
+        &algorithms,
+    const std::vector<size_t> &sizes,
+    const std::vector<DataDistribution> &distributions, size_t num_runs = 5) {
+  compareSortingAlgorithms<T>(algorithms, sizes, distributions,
+                              generateData<T>, num_runs);
+}
+
 } // namespace benchmark
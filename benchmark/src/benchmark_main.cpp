@@ -1,15 +1,29 @@
 #include <algorithm>
+#include <array>
 #include <benchmark_utility.hpp>
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <queue>
 #include <sorting-algorithm/bubble_sort.hpp>
+#include <sorting-algorithm/dary_heap.hpp>
+#include <sorting-algorithm/external_sort.hpp>
 #include <sorting-algorithm/heap_sort.hpp>
 #include <sorting-algorithm/insert_sort.hpp>
 #include <sorting-algorithm/merge_sort.hpp>
+#include <sorting-algorithm/msd_radix_sort.hpp>
+#include <sorting-algorithm/natural_merge_sort.hpp>
 #include <sorting-algorithm/quick_sort.hpp>
 #include <sorting-algorithm/radix_sort.hpp>
+#include <sorting-algorithm/selection.hpp>
+#include <sorting-algorithm/sort.hpp>
 #include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 // Standard library sort for comparison
@@ -26,6 +40,35 @@ template <typename T> void heap_sort_wrapper(std::vector<T> &data) {
   sorting::heap_sort(data);
 }
 
+template <typename T, size_t Arity>
+void dary_heap_sort_wrapper(std::vector<T> &data) {
+  sorting::heap_sort<Arity>(data);
+}
+
+// Push every element into a priority queue and pop them all back in order,
+// which measures push and pop throughput
+template <typename T> void priority_queue_wrapper(std::vector<T> &data) {
+  auto queue = std::priority_queue<T>();
+  for (const auto &x : data) {
+    queue.push(x);
+  }
+  for (auto iter = data.rbegin(); iter != data.rend(); ++iter) {
+    *iter = queue.top();
+    queue.pop();
+  }
+}
+
+template <typename T, size_t D> void dary_heap_wrapper(std::vector<T> &data) {
+  auto heap = sorting::dary_heap<T, D>();
+  heap.reserve(data.size());
+  for (const auto &x : data) {
+    heap.push(x);
+  }
+  for (auto iter = data.rbegin(); iter != data.rend(); ++iter) {
+    *iter = heap.pop();
+  }
+}
+
 template <typename T> void insert_sort_wrapper(std::vector<T> &data) {
   sorting::insert_sort(data);
 }
@@ -34,14 +77,180 @@ template <typename T> void merge_sort_wrapper(std::vector<T> &data) {
   sorting::merge_sort(data);
 }
 
+template <typename T>
+void natural_merge_sort_wrapper(std::vector<T> &data) {
+  sorting::natural_merge_sort(data);
+}
+
+template <typename T> void parallel_merge_sort_wrapper(std::vector<T> &data) {
+  sorting::parallel_merge_sort(data);
+}
+
 template <typename T> void quick_sort_wrapper(std::vector<T> &data) {
   sorting::quick_sort(data);
 }
 
+template <typename T> void block_quick_sort_wrapper(std::vector<T> &data) {
+  sorting::quick_sort<sorting::partition_kernel::block>(data);
+}
+
+template <typename T> void pdq_quick_sort_wrapper(std::vector<T> &data) {
+  sorting::quick_sort<sorting::partition_kernel::pdq>(data);
+}
+
+template <typename T> void simd_quick_sort_wrapper(std::vector<T> &data) {
+  sorting::quick_sort<sorting::partition_kernel::simd>(data);
+}
+
+template <typename T> void parallel_quick_sort_wrapper(std::vector<T> &data) {
+  sorting::parallel_quick_sort(data);
+}
+
 template <typename T> void radix_sort_wrapper(std::vector<T> &data) {
   sorting::radix_sort(data);
 }
 
+// Radix sort with every scatter going straight to its destination
+template <typename T>
+void radix_sort_direct_scatter_wrapper(std::vector<T> &data) {
+  sorting::radix_sort<sorting::radix_auto_digit_bit, SIZE_MAX>(data);
+}
+
+template <typename T> void parallel_radix_sort_wrapper(std::vector<T> &data) {
+  sorting::parallel_radix_sort(data);
+}
+
+template <typename T> void msd_radix_sort_wrapper(std::vector<T> &data) {
+  sorting::msd_radix_sort(data);
+}
+
+template <typename T> void adaptive_sort_wrapper(std::vector<T> &data) {
+  sorting::sort(data);
+}
+
+// Selection: the median, and the least selection_count elements in order
+inline constexpr size_t selection_count = 100;
+
+template <typename T> void std_nth_element(std::vector<T> &data) {
+  std::ranges::nth_element(data, data.begin() + data.size() / 2);
+}
+
+template <typename T> void nth_element_wrapper(std::vector<T> &data) {
+  sorting::nth_element(data, data.begin() + data.size() / 2);
+}
+
+template <typename T> void std_partial_sort(std::vector<T> &data) {
+  std::ranges::partial_sort(
+      data, data.begin() + std::min(selection_count, data.size()));
+}
+
+template <typename T> void partial_sort_wrapper(std::vector<T> &data) {
+  sorting::partial_sort(data,
+                        data.begin() + std::min(selection_count, data.size()));
+}
+
+template <typename T> void top_k_wrapper(std::vector<T> &data) {
+  const auto top = sorting::top_k(data, selection_count);
+  std::ranges::copy(top, data.begin());
+}
+
+// Sorting everything and keeping the first selection_count
+template <typename T> void sort_truncate_wrapper(std::vector<T> &data) {
+  sorting::sort(data);
+  data.resize(std::min(selection_count, data.size()));
+}
+
+// Throws if a file operation of external_sort_wrapper failed, as
+// external_sort does, so that a broken case is not timed
+void checkFile(bool ok, const std::filesystem::path &path) {
+  if (!ok) {
+    throw std::system_error(errno, std::generic_category(),
+                            "external_sort_wrapper: " + path.string());
+  }
+}
+
+// Writes data to a temp file, sorts it there with a memory budget of
+// BudgetMiB and reads it back, so the file I/O is timed too
+template <typename T, size_t BudgetMiB>
+void external_sort_wrapper(std::vector<T> &data) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    "benchmark_external_sort";
+  auto file = std::fopen(path.string().c_str(), "wb");
+  checkFile(file != nullptr, path);
+  const size_t written = std::fwrite(data.data(), sizeof(T), data.size(), file);
+  checkFile(std::fclose(file) == 0 && written == data.size(), path);
+
+  auto options = sorting::external_sort_options();
+  options.memory_budget = BudgetMiB << 20;
+  sorting::external_sort<T>(path, path, options);
+
+  file = std::fopen(path.string().c_str(), "rb");
+  checkFile(file != nullptr, path);
+  const size_t read = std::fread(data.data(), sizeof(T), data.size(), file);
+  std::fclose(file);
+  checkFile(read == data.size(), path);
+  std::filesystem::remove(path);
+}
+
+// A wide record sorted by its key
+struct Record {
+  uint64_t key;
+  std::array<uint32_t, 6> payload;
+};
+
+std::vector<Record>
+generateRecords(size_t size, benchmark::DataDistribution distribution) {
+  auto keys = benchmark::generateData<uint64_t>(size, distribution);
+  auto records = std::vector<Record>(size);
+  for (size_t i = 0; i < size; ++i) {
+    records[i].key = keys[i];
+    records[i].payload.fill(static_cast<uint32_t>(i));
+  }
+  return records;
+}
+
+void radix_sort_record_wrapper(std::vector<Record> &data) {
+  sorting::radix_sort(data, &Record::key);
+}
+
+void std_sort_record(std::vector<Record> &data) {
+  std::ranges::sort(data, {}, &Record::key);
+}
+
+void std_stable_sort_record(std::vector<Record> &data) {
+  std::ranges::stable_sort(data, {}, &Record::key);
+}
+
+// Prints "skipped/total" radix passes for each size and distribution
+template <typename T>
+void reportRadixSkippedPasses(
+    const std::vector<size_t> &sizes,
+    const std::vector<benchmark::DataDistribution> &distributions) {
+  std::cout << "===== Radix Sort skipped passes with " << typeid(T).name()
+            << " =====" << std::endl;
+
+  std::cout << std::left << std::setw(15) << "Size";
+  for (const auto &dist : distributions) {
+    std::cout << std::setw(15) << benchmark::getDistributionName(dist);
+  }
+  std::cout << std::endl;
+
+  for (size_t size : sizes) {
+    std::cout << std::left << std::setw(15) << size;
+    for (const auto &dist : distributions) {
+      auto data = benchmark::generateData<T>(size, dist);
+      auto stats = sorting::radix_sort_stats();
+      sorting::radix_sort(data, &stats);
+      std::cout << std::setw(15)
+                << (std::to_string(stats.skipped_pass_count) + "/" +
+                    std::to_string(stats.pass_count));
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+}
+
 int main() {
   // Define input sizes to test
   std::vector<size_t> sizes = {
@@ -69,10 +278,24 @@ int main() {
   std::vector<
       std::pair<std::string, std::function<void(std::vector<int32_t> &)>>>
       algorithms = {{"Heap Sort", heap_sort_wrapper<int32_t>},
+                    {"4-ary Heap Sort", dary_heap_sort_wrapper<int32_t, 4>},
+                    {"8-ary Heap Sort", dary_heap_sort_wrapper<int32_t, 8>},
                     {"Insert Sort", insert_sort_wrapper<int32_t>},
                     {"Merge Sort", merge_sort_wrapper<int32_t>},
+                    {"Natural Merge Sort", natural_merge_sort_wrapper<int32_t>},
+                    {"Parallel Merge Sort",
+                     parallel_merge_sort_wrapper<int32_t>},
                     {"Quick Sort", quick_sort_wrapper<int32_t>},
+                    {"Block Quick Sort", block_quick_sort_wrapper<int32_t>},
+                    {"PDQ Quick Sort", pdq_quick_sort_wrapper<int32_t>},
+                    {"SIMD Quick Sort", simd_quick_sort_wrapper<int32_t>},
+                    {"Parallel Quick Sort",
+                     parallel_quick_sort_wrapper<int32_t>},
                     {"Radix Sort", radix_sort_wrapper<int32_t>},
+                    {"Parallel Radix Sort",
+                     parallel_radix_sort_wrapper<int32_t>},
+                    {"MSD Radix Sort", msd_radix_sort_wrapper<int32_t>},
+                    {"Adaptive Sort", adaptive_sort_wrapper<int32_t>},
                     {"std::sort", std_sort<int32_t>}};
 
   // Define algorithms including bubble sort (for small datasets only)
@@ -106,10 +329,28 @@ int main() {
   std::vector<
       std::pair<std::string, std::function<void(std::vector<uint32_t> &)>>>
       algorithms_uint = {{"Heap Sort", heap_sort_wrapper<uint32_t>},
+                         {"4-ary Heap Sort",
+                          dary_heap_sort_wrapper<uint32_t, 4>},
+                         {"8-ary Heap Sort",
+                          dary_heap_sort_wrapper<uint32_t, 8>},
                          {"Insert Sort", insert_sort_wrapper<uint32_t>},
                          {"Merge Sort", merge_sort_wrapper<uint32_t>},
+                         {"Natural Merge Sort",
+                          natural_merge_sort_wrapper<uint32_t>},
+                         {"Parallel Merge Sort",
+                          parallel_merge_sort_wrapper<uint32_t>},
                          {"Quick Sort", quick_sort_wrapper<uint32_t>},
+                         {"Block Quick Sort",
+                          block_quick_sort_wrapper<uint32_t>},
+                         {"PDQ Quick Sort", pdq_quick_sort_wrapper<uint32_t>},
+                         {"SIMD Quick Sort", simd_quick_sort_wrapper<uint32_t>},
+                         {"Parallel Quick Sort",
+                          parallel_quick_sort_wrapper<uint32_t>},
                          {"Radix Sort", radix_sort_wrapper<uint32_t>},
+                         {"Parallel Radix Sort",
+                          parallel_radix_sort_wrapper<uint32_t>},
+                         {"MSD Radix Sort", msd_radix_sort_wrapper<uint32_t>},
+                         {"Adaptive Sort", adaptive_sort_wrapper<uint32_t>},
                          {"std::sort", std_sort<uint32_t>}};
 
   // Define algorithms including bubble sort (for small datasets only)
@@ -143,10 +384,28 @@ int main() {
   std::vector<
       std::pair<std::string, std::function<void(std::vector<int64_t> &)>>>
       algorithms_int64 = {{"Heap Sort", heap_sort_wrapper<int64_t>},
+                          {"4-ary Heap Sort",
+                           dary_heap_sort_wrapper<int64_t, 4>},
+                          {"8-ary Heap Sort",
+                           dary_heap_sort_wrapper<int64_t, 8>},
                           {"Insert Sort", insert_sort_wrapper<int64_t>},
                           {"Merge Sort", merge_sort_wrapper<int64_t>},
+                          {"Natural Merge Sort",
+                           natural_merge_sort_wrapper<int64_t>},
+                          {"Parallel Merge Sort",
+                           parallel_merge_sort_wrapper<int64_t>},
                           {"Quick Sort", quick_sort_wrapper<int64_t>},
+                          {"Block Quick Sort",
+                           block_quick_sort_wrapper<int64_t>},
+                          {"PDQ Quick Sort", pdq_quick_sort_wrapper<int64_t>},
+                          {"SIMD Quick Sort", simd_quick_sort_wrapper<int64_t>},
+                          {"Parallel Quick Sort",
+                           parallel_quick_sort_wrapper<int64_t>},
                           {"Radix Sort", radix_sort_wrapper<int64_t>},
+                          {"Parallel Radix Sort",
+                           parallel_radix_sort_wrapper<int64_t>},
+                          {"MSD Radix Sort", msd_radix_sort_wrapper<int64_t>},
+                          {"Adaptive Sort", adaptive_sort_wrapper<int64_t>},
                           {"std::sort", std_sort<int64_t>}};
 
   // Define algorithms including bubble sort (for small datasets only)
@@ -179,10 +438,29 @@ int main() {
   std::vector<
       std::pair<std::string, std::function<void(std::vector<uint64_t> &)>>>
       algorithms_uint64 = {{"Heap Sort", heap_sort_wrapper<uint64_t>},
+                           {"4-ary Heap Sort",
+                            dary_heap_sort_wrapper<uint64_t, 4>},
+                           {"8-ary Heap Sort",
+                            dary_heap_sort_wrapper<uint64_t, 8>},
                            {"Insert Sort", insert_sort_wrapper<uint64_t>},
                            {"Merge Sort", merge_sort_wrapper<uint64_t>},
+                           {"Natural Merge Sort",
+                            natural_merge_sort_wrapper<uint64_t>},
+                           {"Parallel Merge Sort",
+                            parallel_merge_sort_wrapper<uint64_t>},
                            {"Quick Sort", quick_sort_wrapper<uint64_t>},
+                           {"Block Quick Sort",
+                            block_quick_sort_wrapper<uint64_t>},
+                           {"PDQ Quick Sort", pdq_quick_sort_wrapper<uint64_t>},
+                           {"SIMD Quick Sort",
+                            simd_quick_sort_wrapper<uint64_t>},
+                           {"Parallel Quick Sort",
+                            parallel_quick_sort_wrapper<uint64_t>},
                            {"Radix Sort", radix_sort_wrapper<uint64_t>},
+                           {"Parallel Radix Sort",
+                            parallel_radix_sort_wrapper<uint64_t>},
+                           {"MSD Radix Sort", msd_radix_sort_wrapper<uint64_t>},
+                           {"Adaptive Sort", adaptive_sort_wrapper<uint64_t>},
                            {"std::sort", std_sort<uint64_t>}};
 
   // Define algorithms including bubble sort (for small datasets only)
@@ -210,5 +488,136 @@ int main() {
   benchmark::compareSortingAlgorithms<uint64_t>(algorithms_uint64, sizes,
                                                 distributions);
 
+  // Define the sorting algorithms for double
+  std::vector<
+      std::pair<std::string, std::function<void(std::vector<double> &)>>>
+      algorithms_double = {{"Heap Sort", heap_sort_wrapper<double>},
+                           {"4-ary Heap Sort",
+                            dary_heap_sort_wrapper<double, 4>},
+                           {"8-ary Heap Sort",
+                            dary_heap_sort_wrapper<double, 8>},
+                           {"Insert Sort", insert_sort_wrapper<double>},
+                           {"Merge Sort", merge_sort_wrapper<double>},
+                           {"Natural Merge Sort",
+                            natural_merge_sort_wrapper<double>},
+                           {"Parallel Merge Sort",
+                            parallel_merge_sort_wrapper<double>},
+                           {"Quick Sort", quick_sort_wrapper<double>},
+                           {"Block Quick Sort",
+                            block_quick_sort_wrapper<double>},
+                           {"PDQ Quick Sort", pdq_quick_sort_wrapper<double>},
+                           {"SIMD Quick Sort", simd_quick_sort_wrapper<double>},
+                           {"Parallel Quick Sort",
+                            parallel_quick_sort_wrapper<double>},
+                           {"Radix Sort", radix_sort_wrapper<double>},
+                           {"Parallel Radix Sort",
+                            parallel_radix_sort_wrapper<double>},
+                           {"MSD Radix Sort", msd_radix_sort_wrapper<double>},
+                           {"Adaptive Sort", adaptive_sort_wrapper<double>},
+                           {"std::sort", std_sort<double>}};
+
+  // Run benchmarks for double type (all datasets)
+  std::cout << "\n=== BENCHMARKING WITH double TYPE (EFFICIENT ALGORITHMS, "
+               "ALL DATASETS) ===\n"
+            << std::endl;
+  benchmark::compareSortingAlgorithms<double>(algorithms_double, sizes,
+                                              distributions);
+
+  // Run benchmarks for records sorted by a uint64_t key
+  std::vector<
+      std::pair<std::string, std::function<void(std::vector<Record> &)>>>
+      algorithms_record = {{"Radix Sort", radix_sort_record_wrapper},
+                           {"std::sort", std_sort_record},
+                           {"std::stable_sort", std_stable_sort_record}};
+
+  std::cout << "\n=== BENCHMARKING WITH 32-byte RECORDS BY uint64_t KEY "
+               "(ALL DATASETS) ===\n"
+            << std::endl;
+  benchmark::compareSortingAlgorithms<Record>(algorithms_record, sizes,
+                                              distributions, generateRecords);
+
+  // Radix passes whose digit is constant are skipped; Narrow Range data
+  // shares its high digits like timestamps do
+  auto radix_distributions = distributions;
+  radix_distributions.push_back(benchmark::DataDistribution::NarrowRange);
+
+  std::cout << "\n=== RADIX SORT SKIPPED PASSES ===\n" << std::endl;
+  reportRadixSkippedPasses<uint32_t>(sizes, radix_distributions);
+  reportRadixSkippedPasses<uint64_t>(sizes, radix_distributions);
+  benchmark::compareSortingAlgorithms<uint64_t>(
+      {{"Radix Sort", radix_sort_wrapper<uint64_t>},
+       {"std::sort", std_sort<uint64_t>}},
+      sizes, {benchmark::DataDistribution::NarrowRange});
+
+  // Write-combining only pays off once the data outgrows the cache; sizes up
+  // to 1e9 can be added here given the memory
+  const std::vector<size_t> huge_sizes = {10000000};
+  const std::vector<benchmark::DataDistribution> huge_distributions = {
+      benchmark::DataDistribution::Random,
+      benchmark::DataDistribution::FewUnique};
+  std::cout << "\n=== RADIX SORT WRITE-COMBINING SCATTER ===\n" << std::endl;
+  benchmark::compareSortingAlgorithms<uint32_t>(
+      {{"Write-combined", radix_sort_wrapper<uint32_t>},
+       {"Direct scatter", radix_sort_direct_scatter_wrapper<uint32_t>}},
+      huge_sizes, huge_distributions, 2);
+  benchmark::compareSortingAlgorithms<uint64_t>(
+      {{"Write-combined", radix_sort_wrapper<uint64_t>},
+       {"Direct scatter", radix_sort_direct_scatter_wrapper<uint64_t>}},
+      huge_sizes, huge_distributions, 2);
+
+  // The budgets split 50M records (400 MB) into 96 and 12 runs, which take
+  // three merge passes and one
+  std::cout << "\n=== EXTERNAL SORT ===\n" << std::endl;
+  benchmark::compareSortingAlgorithms<uint64_t>(
+      {{"External Sort 8 MiB", external_sort_wrapper<uint64_t, 8>},
+       {"External Sort 64 MiB", external_sort_wrapper<uint64_t, 64>},
+       {"Radix Sort", radix_sort_wrapper<uint64_t>}},
+      {10000000, 50000000}, {benchmark::DataDistribution::Random}, 1);
+
+  std::cout << "\n=== SELECTION ===\n" << std::endl;
+  auto selection_sizes = sizes;
+  selection_sizes.push_back(1000000);
+  selection_sizes.push_back(10000000);
+  const std::vector<benchmark::DataDistribution> selection_distributions = {
+      benchmark::DataDistribution::Random,
+      benchmark::DataDistribution::Sorted,
+      benchmark::DataDistribution::FewUnique};
+  benchmark::compareSortingAlgorithms<int32_t>(
+      {{"std::nth_element", std_nth_element<int32_t>},
+       {"nth_element", nth_element_wrapper<int32_t>},
+       {"std::partial_sort", std_partial_sort<int32_t>},
+       {"partial_sort", partial_sort_wrapper<int32_t>},
+       {"top_k", top_k_wrapper<int32_t>},
+       {"Sort and truncate", sort_truncate_wrapper<int32_t>}},
+      selection_sizes, selection_distributions, 2);
+  benchmark::compareSortingAlgorithms<double>(
+      {{"std::nth_element", std_nth_element<double>},
+       {"nth_element", nth_element_wrapper<double>},
+       {"std::partial_sort", std_partial_sort<double>},
+       {"partial_sort", partial_sort_wrapper<double>},
+       {"top_k", top_k_wrapper<double>},
+       {"Sort and truncate", sort_truncate_wrapper<double>}},
+      selection_sizes, selection_distributions, 2);
+
+  std::cout << "\n=== PRIORITY QUEUE PUSH/POP ===\n" << std::endl;
+  auto queue_sizes = sizes;
+  queue_sizes.push_back(1000000);
+  const std::vector<benchmark::DataDistribution> queue_distributions = {
+      benchmark::DataDistribution::Random,
+      benchmark::DataDistribution::Sorted,
+      benchmark::DataDistribution::FewUnique};
+  benchmark::compareSortingAlgorithms<int32_t>(
+      {{"std::priority_queue", priority_queue_wrapper<int32_t>},
+       {"2-ary dary_heap", dary_heap_wrapper<int32_t, 2>},
+       {"4-ary dary_heap", dary_heap_wrapper<int32_t, 4>},
+       {"8-ary dary_heap", dary_heap_wrapper<int32_t, 8>}},
+      queue_sizes, queue_distributions);
+  benchmark::compareSortingAlgorithms<uint64_t>(
+      {{"std::priority_queue", priority_queue_wrapper<uint64_t>},
+       {"2-ary dary_heap", dary_heap_wrapper<uint64_t, 2>},
+       {"4-ary dary_heap", dary_heap_wrapper<uint64_t, 4>},
+       {"8-ary dary_heap", dary_heap_wrapper<uint64_t, 8>}},
+      queue_sizes, queue_distributions);
+
   return 0;
 }
@@ -1,18 +1,25 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <ranges>
+#include <utility>
+
+#include <sorting-algorithm/comparator.hpp>
 
 namespace sorting {
 
-template <std::ranges::random_access_range Range>
-void bubble_sort(Range &range) {
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void bubble_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
   auto begin = std::begin(range);
   auto end = std::end(range);
+  auto less = projected_comp(std::move(comp), std::move(proj));
 
   for (auto i = begin; i != end; ++i) {
     for (auto j = begin; j != end - 1 - (i - begin); ++j) {
-      if (*(j + 1) < *j) {
+      if (less(*(j + 1), *j)) {
         std::iter_swap(j, j + 1);
       }
     }
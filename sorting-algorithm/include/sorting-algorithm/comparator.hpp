@@ -0,0 +1,33 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <utility>
+
+namespace sorting {
+
+namespace {
+// Whether Comp orders elements of type T by their operator<, which the
+// sorting networks and SIMD kernels implement directly
+template <typename Comp, typename T>
+inline constexpr bool is_default_less =
+    std::same_as<Comp, std::ranges::less> || std::same_as<Comp, std::less<>> ||
+    std::same_as<Comp, std::less<T>>;
+
+// Orders elements as comp orders their projections. Without a projection this
+// is comp itself, so that is_default_less still sees through it and nothing
+// is left to inline.
+template <typename Comp, typename Proj>
+auto projected_comp(Comp comp, Proj proj) {
+  if constexpr (std::same_as<Proj, std::identity>) {
+    return comp;
+  } else {
+    return [comp = std::move(comp), proj = std::move(proj)](
+               const auto &x, const auto &y) mutable -> bool {
+      return std::invoke(comp, std::invoke(proj, x), std::invoke(proj, y));
+    };
+  }
+}
+} // namespace
+
+} // namespace sorting
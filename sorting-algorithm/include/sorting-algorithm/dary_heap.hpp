@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include <sorting-algorithm/heap_sort.hpp>
+
+namespace sorting {
+
+// Priority queue on a D-ary heap, laid out and sifted as in heap_sort<D>.
+// top() is the largest element by Compare, as in std::priority_queue. The
+// elements live in one contiguous buffer, which does not reallocate while
+// size() stays within a reserved capacity().
+template <typename T, size_t D = 4, typename Compare = std::less<T>>
+class dary_heap {
+public:
+  static_assert(D >= 2);
+
+  using value_type = T;
+  using value_compare = Compare;
+
+  dary_heap() = default;
+
+  explicit dary_heap(const Compare &comp) : comp_(comp) {}
+
+  // Builds the heap from the elements of range in O(n)
+  template <std::ranges::input_range Range>
+  explicit dary_heap(Range &&range, const Compare &comp = Compare())
+      : data_(std::ranges::begin(range), std::ranges::end(range)),
+        comp_(comp) {
+    heapify<D>(data_.begin(), data_.size(), comp_);
+  }
+
+  bool empty() const { return data_.empty(); }
+
+  size_t size() const { return data_.size(); }
+
+  size_t capacity() const { return data_.capacity(); }
+
+  void reserve(size_t capacity) { data_.reserve(capacity); }
+
+  const T &top() const {
+    assert(!empty());
+    return data_.front();
+  }
+
+  void push(T value) {
+    data_.push_back(std::move(value));
+    sift_up<D>(data_.begin(), 0, data_.size() - 1, std::move(data_.back()),
+               comp_);
+  }
+
+  // Removes and returns the top element
+  T pop() {
+    assert(!empty());
+    auto top = std::move(data_.front());
+    auto last = std::move(data_.back());
+    data_.pop_back();
+    if (!data_.empty()) {
+      sift_down<D>(data_.begin(), data_.size(), 0, std::move(last), comp_);
+    }
+    return top;
+  }
+
+  // Same as a pop() followed by push(value), at the cost of a single sift:
+  // the step of a top-k selection that finds a smaller element than the
+  // largest kept so far
+  T replace_top(T value) {
+    assert(!empty());
+    auto top = std::move(data_.front());
+    sift_down<D>(data_.begin(), data_.size(), 0, std::move(value), comp_);
+    return top;
+  }
+
+  void clear() { data_.clear(); }
+
+private:
+  std::vector<T> data_;
+  [[no_unique_address]] Compare comp_;
+};
+
+} // namespace sorting
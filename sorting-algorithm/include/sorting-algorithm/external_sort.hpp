@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sorting-algorithm/radix_sort.hpp>
+
+namespace sorting {
+
+// Settings of external_sort
+struct external_sort_options {
+  // Bytes of records held in memory at once: a run and radix_sort's scratch
+  // buffer while runs are formed, the read and write buffers while merging
+  size_t memory_budget = size_t(1) << 30;
+  // Directory under which the runs are spilled, in a subdirectory of their
+  // own that is removed afterwards. Empty means the system's temp directory.
+  std::filesystem::path temp_dir;
+  // Bytes read from each run and written to the output at a time while
+  // merging. At most memory_budget / merge_buffer_size - 1 runs are merged at
+  // once; more take more than one merge pass.
+  size_t merge_buffer_size = size_t(1) << 20;
+};
+
+// Progress of external_sort, updated as it goes so that another thread can
+// poll it
+struct external_sort_stats {
+  // Records in the input
+  std::atomic<size_t> record_count = 0;
+  // Records sorted into runs so far
+  std::atomic<size_t> run_record_count = 0;
+  // Runs spilled, by run formation and by all but the last merge pass
+  std::atomic<size_t> run_count = 0;
+  std::atomic<size_t> spilled_bytes = 0;
+  // Merge passes started; the last one writes the output
+  std::atomic<size_t> merge_pass_count = 0;
+  // Records written by the current merge pass
+  std::atomic<size_t> merged_record_count = 0;
+};
+
+namespace {
+struct file_closer {
+  void operator()(std::FILE *file) const { std::fclose(file); }
+};
+using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+inline file_ptr open_file(const std::filesystem::path &path,
+                          const char *mode) {
+  auto file = file_ptr(std::fopen(path.string().c_str(), mode));
+  if (file == nullptr) {
+    throw std::system_error(errno, std::generic_category(),
+                            "external_sort: cannot open " + path.string());
+  }
+  return file;
+}
+
+// Closes a file that was written to, which flushes what it buffered
+inline void close_file(file_ptr &file) {
+  if (std::fclose(file.release()) != 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "external_sort: cannot write");
+  }
+}
+
+// Reads up to records.size() records and returns how many were read
+template <typename T>
+size_t read_records(std::FILE *file, std::span<T> records) {
+  const size_t count =
+      std::fread(records.data(), sizeof(T), records.size(), file);
+  if (count < records.size() && std::ferror(file)) {
+    throw std::system_error(errno, std::generic_category(),
+                            "external_sort: cannot read");
+  }
+  return count;
+}
+
+template <typename T>
+void write_records(std::FILE *file, std::span<const T> records) {
+  if (std::fwrite(records.data(), sizeof(T), records.size(), file) !=
+      records.size()) {
+    throw std::system_error(errno, std::generic_category(),
+                            "external_sort: cannot write");
+  }
+}
+
+// Directory of the runs of one external_sort, removed with them when it goes
+// out of scope
+class run_directory {
+public:
+  explicit run_directory(const std::filesystem::path &temp_dir) {
+    const auto parent =
+        temp_dir.empty() ? std::filesystem::temp_directory_path() : temp_dir;
+    auto random = std::random_device();
+    do {
+      path_ = parent / ("external_sort-" + std::to_string(random()));
+    } while (!std::filesystem::create_directory(path_));
+  }
+
+  run_directory(const run_directory &) = delete;
+  run_directory &operator=(const run_directory &) = delete;
+
+  ~run_directory() {
+    auto error = std::error_code();
+    std::filesystem::remove_all(path_, error);
+  }
+
+  // A path for another run file
+  std::filesystem::path next_run_path() {
+    return path_ / ("run-" + std::to_string(run_count_++));
+  }
+
+private:
+  std::filesystem::path path_;
+  size_t run_count_ = 0;
+};
+
+// Writes records to another run file of directory and returns its path
+template <typename T>
+std::filesystem::path spill_run(run_directory &directory,
+                                std::span<const T> records,
+                                external_sort_stats *stats) {
+  auto path = directory.next_run_path();
+  auto file = open_file(path, "wb");
+  write_records(file.get(), records);
+  close_file(file);
+  if (stats != nullptr) {
+    stats->run_count += 1;
+    stats->spilled_bytes += records.size_bytes();
+  }
+  return path;
+}
+
+// Reads a run file front to back through a buffer of buffer_size records
+template <typename T> class run_reader {
+public:
+  run_reader(const std::filesystem::path &path, size_t buffer_size)
+      : file_(open_file(path, "rb")), buffer_(buffer_size) {
+    fill();
+  }
+
+  bool empty() const { return pos_ == end_; }
+  const T &front() const { return buffer_[pos_]; }
+
+  void pop() {
+    if (++pos_ == end_) {
+      fill();
+    }
+  }
+
+private:
+  void fill() {
+    pos_ = 0;
+    end_ = read_records(file_.get(), std::span(buffer_));
+  }
+
+  file_ptr file_;
+  std::vector<T> buffer_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+};
+
+// Tournament tree for a k-way merge. Every inner node keeps the loser of the
+// match played there, key included, and the overall winner is kept apart, so
+// replacing the winner's key replays only the matches on its path to the
+// root, with one comparison per level against the loser kept there.
+// Exhausted sources take the greatest key and lose its ties; other ties go to
+// the lower source, which keeps the merge stable.
+template <typename Key> class loser_tree {
+public:
+  explicit loser_tree(std::span<const Key> keys) : losers_(keys.size()) {
+    // Winners of every subtree, played bottom up; leaf i is node size + i
+    const size_t size = keys.size();
+    auto winners = std::vector<entry>(2 * size);
+    for (size_t i = 0; i < size; ++i) {
+      winners[size + i] = {keys[i], i};
+    }
+    for (size_t node = size - 1; node > 0; --node) {
+      auto left = winners[2 * node];
+      auto right = winners[2 * node + 1];
+      if (is_before(right, left)) {
+        std::swap(left, right);
+      }
+      winners[node] = left;
+      losers_[node] = right;
+    }
+    winner_ = winners[1];
+  }
+
+  // Whether every source is exhausted
+  bool empty() const { return winner_.rank >= losers_.size(); }
+  // The source with the least key
+  size_t winner() const { return winner_.rank; }
+
+  void replace_winner(Key key) {
+    winner_.key = key;
+    replay();
+  }
+
+  void remove_winner() {
+    winner_.key = std::numeric_limits<Key>::max();
+    winner_.rank += losers_.size();
+    replay();
+  }
+
+private:
+  struct entry {
+    Key key;
+    // The source, plus the source count once it is exhausted
+    size_t rank;
+  };
+
+  static bool is_before(const entry &a, const entry &b) {
+    return a.key < b.key || (a.key == b.key && a.rank < b.rank);
+  }
+
+  void replay() {
+    const size_t size = losers_.size();
+    const size_t source =
+        winner_.rank < size ? winner_.rank : winner_.rank - size;
+    for (size_t node = (size + source) / 2; node > 0; node /= 2) {
+      if (is_before(losers_[node], winner_)) {
+        std::swap(losers_[node], winner_);
+      }
+    }
+  }
+
+  std::vector<entry> losers_;
+  entry winner_;
+};
+
+// Merges the run files into output with a loser tree over their radix keys
+template <typename T, typename Proj>
+void merge_runs(std::span<const std::filesystem::path> runs,
+                std::FILE *output, size_t buffer_size, Proj &proj,
+                external_sort_stats *stats) {
+  auto key = [&proj](const T &x) { return radix_key(std::invoke(proj, x)); };
+  using KeyT = decltype(key(std::declval<const T &>()));
+
+  auto readers = std::vector<run_reader<T>>();
+  readers.reserve(runs.size());
+  auto keys = std::vector<KeyT>(runs.size());
+  for (size_t i = 0; i < runs.size(); ++i) {
+    readers.emplace_back(runs[i], buffer_size);
+    assert(!readers[i].empty());
+    keys[i] = key(readers[i].front());
+  }
+  auto tree = loser_tree<KeyT>(keys);
+
+  auto buffer = std::vector<T>();
+  buffer.reserve(buffer_size);
+  auto flush = [&] {
+    write_records(output, std::span<const T>(buffer));
+    if (stats != nullptr) {
+      stats->merged_record_count += buffer.size();
+    }
+    buffer.clear();
+  };
+  while (!tree.empty()) {
+    auto &reader = readers[tree.winner()];
+    buffer.push_back(reader.front());
+    if (buffer.size() == buffer_size) {
+      flush();
+    }
+    reader.pop();
+    if (reader.empty()) {
+      tree.remove_winner();
+    } else {
+      tree.replace_winner(key(reader.front()));
+    }
+  }
+  flush();
+}
+} // namespace
+
+// Sorts the file input of fixed-width records T by the key proj(x), an
+// integer or an IEEE float, into the file output, which may be input itself,
+// using about options.memory_budget bytes of memory for any input size. Runs
+// of the input that fit in half the budget are radix sorted and spilled to
+// options.temp_dir, then merged with a loser tree, in more than one pass if
+// there are too many of them for the merge buffers; an input that fits in
+// one run is sorted in memory. Stable. If stats is given, progress is counted
+// there. Throws std::system_error on I/O errors and std::invalid_argument if
+// input is not a whole number of records.
+template <typename T, typename Proj>
+  requires std::is_trivially_copyable_v<T> &&
+           std::invocable<Proj &, const T &>
+void external_sort(const std::filesystem::path &input,
+                   const std::filesystem::path &output, Proj proj,
+                   const external_sort_options &options = {},
+                   external_sort_stats *stats = nullptr) {
+  using KeyT = std::remove_cvref_t<std::invoke_result_t<Proj &, const T &>>;
+  static_assert(radix_key_type<KeyT>);
+
+  const auto file_size = std::filesystem::file_size(input);
+  if (file_size % sizeof(T) != 0) {
+    throw std::invalid_argument("external_sort: " + input.string() +
+                                " is not a whole number of records");
+  }
+  const auto record_count = static_cast<size_t>(file_size / sizeof(T));
+  if (stats != nullptr) {
+    stats->record_count = record_count;
+  }
+
+  // A run and its radix_sort scratch, and for merging a buffer per run and
+  // one for the output, share the budget
+  const size_t run_size =
+      std::max<size_t>(options.memory_budget / (2 * sizeof(T)), 1);
+  const size_t buffer_size =
+      std::max<size_t>(options.merge_buffer_size / sizeof(T), 1);
+  const size_t fan_in = std::max<size_t>(
+      options.memory_budget / (buffer_size * sizeof(T)), 3) - 1;
+
+  auto run = std::vector<T>(std::min(run_size, record_count));
+  auto scratch = std::vector<T>(run.size());
+  auto input_file = open_file(input, "rb");
+
+  // Small enough for one run: sorted in memory, without temp files
+  if (record_count <= run_size) {
+    if (read_records(input_file.get(), std::span(run)) != run.size()) {
+      throw std::runtime_error("external_sort: " + input.string() +
+                               " shrank while being sorted");
+    }
+    input_file.reset();
+    radix_sort(run, std::span(scratch), proj);
+    if (stats != nullptr) {
+      stats->run_record_count = record_count;
+      stats->merge_pass_count += 1;
+    }
+    auto output_file = open_file(output, "wb");
+    write_records(output_file.get(), std::span<const T>(run));
+    close_file(output_file);
+    if (stats != nullptr) {
+      stats->merged_record_count = record_count;
+    }
+    return;
+  }
+
+  auto directory = run_directory(options.temp_dir);
+
+  // Form the runs
+  auto runs = std::vector<std::filesystem::path>();
+  for (size_t begin = 0; begin < record_count; begin += run_size) {
+    const auto count = std::min(run_size, record_count - begin);
+    auto records = std::span(run).first(count);
+    if (read_records(input_file.get(), records) != records.size()) {
+      throw std::runtime_error("external_sort: " + input.string() +
+                               " shrank while being sorted");
+    }
+    radix_sort(records, std::span(scratch), proj);
+    runs.push_back(spill_run<T>(directory, records, stats));
+    if (stats != nullptr) {
+      stats->run_record_count += records.size();
+    }
+  }
+  input_file.reset();
+  // Freed for the merge buffers, which get the whole budget; clear() or = {}
+  // would keep the capacity
+  std::vector<T>().swap(run);
+  std::vector<T>().swap(scratch);
+
+  // Merge fan_in runs at a time into longer ones until one pass is left
+  while (runs.size() > fan_in) {
+    if (stats != nullptr) {
+      stats->merge_pass_count += 1;
+      stats->merged_record_count = 0;
+    }
+    auto merged = std::vector<std::filesystem::path>();
+    for (size_t begin = 0; begin < runs.size(); begin += fan_in) {
+      const auto group = std::span<const std::filesystem::path>(runs).subspan(
+          begin, std::min(fan_in, runs.size() - begin));
+      if (group.size() == 1) {
+        merged.push_back(group.front());
+        continue;
+      }
+      auto path = directory.next_run_path();
+      auto file = open_file(path, "wb");
+      merge_runs<T>(group, file.get(), buffer_size, proj, stats);
+      close_file(file);
+      for (const auto &run_path : group) {
+        std::filesystem::remove(run_path);
+      }
+      if (stats != nullptr) {
+        stats->run_count += 1;
+        stats->spilled_bytes += std::filesystem::file_size(path);
+      }
+      merged.push_back(std::move(path));
+    }
+    runs = std::move(merged);
+  }
+
+  if (stats != nullptr) {
+    stats->merge_pass_count += 1;
+    stats->merged_record_count = 0;
+  }
+  auto output_file = open_file(output, "wb");
+  merge_runs<T>(runs, output_file.get(), buffer_size, proj, stats);
+  close_file(output_file);
+}
+
+// Sorts the file input of integers or IEEE floats T into output, as above
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+void external_sort(const std::filesystem::path &input,
+                   const std::filesystem::path &output,
+                   const external_sort_options &options = {},
+                   external_sort_stats *stats = nullptr) {
+  external_sort<T>(input, output, std::identity(), options, stats);
+}
+
+} // namespace sorting
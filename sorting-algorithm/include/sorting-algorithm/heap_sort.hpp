@@ -1,79 +1,136 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <ranges>
+#include <utility>
+
+#include <sorting-algorithm/comparator.hpp>
 
 namespace sorting {
 
 namespace {
-template <std::random_access_iterator Iter>
-void sift_down(Iter begin, Iter end, Iter root) {
-  const auto size = std::distance(begin, end);
-
-  while (true) {
-    auto root_idx = std::distance(begin, root);
-    auto left_child_idx = 2 * root_idx + 1;
+// The children of node i are [Arity * i, Arity * (i + 1)), except that the
+// root is not its own child. Every set of siblings then starts at a multiple
+// of Arity, so with Arity elements to a cache line each one fills exactly a
+// line of a line-aligned range.
+template <size_t Arity> size_t heap_parent(size_t i) { return i / Arity; }
+
+// Of the indices a and b, the one whose element is larger by comp. Selected
+// by arithmetic rather than a branch, which random keys would mispredict.
+template <std::random_access_iterator Iter, typename Comp>
+size_t heap_larger(Iter begin, size_t a, size_t b, Comp &comp) {
+  return a + (b - a) * static_cast<size_t>(comp(begin[a], begin[b]));
+}
 
-    if (left_child_idx >= size) {
-      // No children, we're done
-      return;
-    }
+// Index of the largest of [first, first + count)
+template <std::random_access_iterator Iter, typename Comp>
+size_t heap_largest(Iter begin, size_t first, size_t count, Comp &comp) {
+  size_t largest = first;
+  for (size_t i = first + 1; i < first + count; ++i) {
+    largest = heap_larger(begin, largest, i, comp);
+  }
+  return largest;
+}
 
-    auto largest = root;
-    auto left_child = begin + left_child_idx;
+// As heap_largest, but as a tournament whose rounds compare independently
+template <size_t Count, std::random_access_iterator Iter, typename Comp>
+size_t heap_largest(Iter begin, size_t first, Comp &comp) {
+  if constexpr (Count == 1) {
+    return first;
+  } else {
+    constexpr size_t Half = Count / 2;
+    return heap_larger(begin, heap_largest<Half>(begin, first, comp),
+                       heap_largest<Count - Half>(begin, first + Half, comp),
+                       comp);
+  }
+}
 
-    if (*largest < *left_child) {
-      largest = left_child;
+// Moves the hole at hole up towards top while its parent is less than value,
+// then puts value into it
+template <size_t Arity, std::random_access_iterator Iter, typename Comp>
+void sift_up(Iter begin, size_t top, size_t hole,
+             std::iter_value_t<Iter> value, Comp &comp) {
+  while (hole != top) {
+    const size_t parent = heap_parent<Arity>(hole);
+    if (!comp(begin[parent], value)) {
+      break;
     }
+    begin[hole] = std::move(begin[parent]);
+    hole = parent;
+  }
+  begin[hole] = std::move(value);
+}
 
-    auto right_child_idx = left_child_idx + 1;
-    if (right_child_idx < size) {
-      auto right_child = begin + right_child_idx;
-      if (*largest < *right_child) {
-        largest = right_child;
-      }
+// Floyd's bottom-up sift: moves the hole at top down along the largest
+// children to a leaf, then value up from there to its place. A level costs
+// Arity - 1 comparisons instead of Arity, and value, which came from the
+// bottom, mostly stays near it.
+template <size_t Arity, std::random_access_iterator Iter, typename Comp>
+void sift_down(Iter begin, size_t size, size_t top,
+               std::iter_value_t<Iter> value, Comp &comp) {
+  size_t hole = top;
+  auto move_up = [&](size_t child) {
+    begin[hole] = std::move(begin[child]);
+    hole = child;
+  };
+
+  if (hole == 0 && size > 1) {
+    move_up(heap_largest(begin, 1, std::min(Arity, size) - 1, comp));
+  }
+  if (hole != 0) {
+    // Nodes with all Arity children
+    while (Arity * (hole + 1) <= size) {
+      move_up(heap_largest<Arity>(begin, Arity * hole, comp));
     }
-
-    if (largest == root) {
-      // Heap property is satisfied
-      return;
+    if (Arity * hole < size) {
+      move_up(heap_largest(begin, Arity * hole, size - Arity * hole, comp));
     }
-
-    std::iter_swap(root, largest);
-    root = largest;
   }
-}
 
-template <std::random_access_iterator Iter> void heapify(Iter begin, Iter end) {
-  const auto size = std::distance(begin, end);
+  sift_up<Arity>(begin, top, hole, std::move(value), comp);
+}
 
-  // Start from the last non-leaf node and sift down
-  for (auto i = size / 2; i > 0; --i) {
-    sift_down(begin, end, begin + (i - 1));
+template <size_t Arity, std::random_access_iterator Iter, typename Comp>
+void heapify(Iter begin, size_t size, Comp &comp) {
+  if (size < 2) {
+    return;
   }
-
-  // Handle the root node separately
-  if (size > 0) {
-    sift_down(begin, end, begin);
+  // Sift down every node that has children, the last one's parent first
+  for (size_t i = heap_parent<Arity>(size - 1) + 1; i > 0; --i) {
+    sift_down<Arity>(begin, size, i - 1, std::move(begin[i - 1]), comp);
   }
 }
-} // namespace
-
-template <std::ranges::random_access_range Range> void heap_sort(Range &range) {
-  auto begin = std::begin(range);
-  auto end = std::end(range);
 
+// Heap sorts the size elements at begin by comp
+template <size_t Arity, std::random_access_iterator Iter, typename Comp>
+void heap_sort_impl(Iter begin, size_t size, Comp comp) {
   // Build max heap
-  heapify(begin, end);
-
-  // Extract elements from the heap one by one
-  for (auto i = end - 1; i > begin; --i) {
-    // Move current root to the end
-    std::iter_swap(begin, i);
-
-    // Call sift_down on the reduced heap
-    sift_down(begin, i, begin);
+  heapify<Arity>(begin, size, comp);
+
+  // Move the root to the end of the shrinking heap, and sift down the
+  // element that was there into the hole it leaves
+  for (size_t end = size; end > 1; --end) {
+    auto value = std::move(begin[end - 1]);
+    begin[end - 1] = std::move(begin[0]);
+    sift_down<Arity>(begin, end - 1, 0, std::move(value), comp);
   }
 }
+} // namespace
+
+// Arity is the number of children per node. A 4-ary or 8-ary heap is half or
+// a third as deep as a binary one and reads each node's children from one
+// cache line, which pays off once the heap outgrows the cache.
+template <size_t Arity = 2, std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void heap_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  static_assert(Arity >= 2);
+  heap_sort_impl<Arity>(std::begin(range),
+                        static_cast<size_t>(std::ranges::distance(range)),
+                        projected_comp(std::move(comp), std::move(proj)));
+}
 
 } // namespace sorting
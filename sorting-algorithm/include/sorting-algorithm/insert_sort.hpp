@@ -1,20 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <ranges>
+#include <utility>
+
+#include <sorting-algorithm/comparator.hpp>
+
 namespace sorting {
 
-template <std::ranges::random_access_range Range>
-void insert_sort(Range &range) {
-  auto iter = std::begin(range);
-  while (iter != std::end(range)) {
-    const auto value = *iter;
-    const auto pos = std::upper_bound(std::begin(range), iter, value);
+namespace {
+template <std::random_access_iterator Iter, typename Comp>
+void insert_sort_impl(Iter begin, Iter end, Comp comp) {
+  for (auto iter = begin; iter != end; ++iter) {
+    auto value = std::move(*iter);
+    const auto pos = std::upper_bound(begin, iter, value, comp);
 
     std::move_backward(pos, iter, iter + 1);
-    *pos = value;
-    iter += 1;
+    *pos = std::move(value);
   }
 }
+} // namespace
+
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void insert_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  insert_sort_impl(std::begin(range), std::end(range),
+                   projected_comp(std::move(comp), std::move(proj)));
+}
 
-} // namespace sorting
\ No newline at end of file
+} // namespace sorting
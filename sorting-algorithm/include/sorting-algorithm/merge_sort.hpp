@@ -2,31 +2,220 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <sorting-algorithm/comparator.hpp>
+#include <sorting-algorithm/insert_sort.hpp>
+#include <sorting-algorithm/sorting_network.hpp>
+#include <sorting-algorithm/thread_pool.hpp>
+
 namespace sorting {
 
 namespace {
-template <std::random_access_iterator IIter>
-void merge_sort_impl(IIter begin, IIter end) {
-  auto size = std::ranges::distance(begin, end);
-  if (size <= 1) {
+// Merges each pair of neighbouring sorted runs of width elements from src
+// into dst
+template <std::random_access_iterator SrcIter,
+          std::random_access_iterator DstIter, typename Comp>
+void merge_pass(SrcIter src, DstIter dst, size_t size, size_t width,
+                Comp comp) {
+  for (size_t begin = 0; begin < size; begin += 2 * width) {
+    const size_t middle = std::min(begin + width, size);
+    const size_t end = std::min(begin + 2 * width, size);
+    std::merge(std::make_move_iterator(src + begin),
+               std::make_move_iterator(src + middle),
+               std::make_move_iterator(src + middle),
+               std::make_move_iterator(src + end), dst + begin, comp);
+  }
+}
+
+// Bottom-up merge sort: sorts short runs in place, then merges runs of
+// doubling width back and forth between [begin, end) and buffer, which must
+// hold at least as many elements
+template <std::random_access_iterator IIter,
+          std::random_access_iterator BufferIter, typename Comp>
+void merge_sort_impl(IIter begin, IIter end, BufferIter buffer, Comp comp) {
+  // Below this size insertion sort beats merging
+  constexpr size_t InsertSortSize = 32;
+  // A sorting network in SIMD registers still does at this size
+  constexpr size_t NetworkSortSize = 64;
+
+  const auto size = static_cast<size_t>(std::ranges::distance(begin, end));
+
+  // The network is not stable, which only integers in their own order cannot
+  // tell
+  using ValueT = std::iter_value_t<IIter>;
+  constexpr bool IsNetworkStable =
+      std::is_integral_v<ValueT> && is_default_less<Comp, ValueT>;
+  const size_t run_size = IsNetworkStable && has_simd_small_sort<IIter>()
+                              ? NetworkSortSize
+                              : InsertSortSize;
+  for (size_t run_begin = 0; run_begin < size; run_begin += run_size) {
+    const size_t run_end = std::min(run_begin + run_size, size);
+    if constexpr (IsNetworkStable) {
+      small_sort(begin + run_begin, begin + run_end);
+    } else {
+      insert_sort_impl(begin + run_begin, begin + run_end, comp);
+    }
+  }
+
+  bool is_in_buffer = false;
+  for (size_t width = run_size; width < size; width *= 2) {
+    if (is_in_buffer) {
+      merge_pass(buffer, begin, size, width, comp);
+    } else {
+      merge_pass(begin, buffer, size, width, comp);
+    }
+    is_in_buffer = !is_in_buffer;
+  }
+
+  if (is_in_buffer) {
+    std::move(buffer, buffer + size, begin);
+  }
+}
+} // namespace
+
+// Uses buffer (at least as long as range) for merging and allocates nothing
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void merge_sort(Range &&range,
+                std::span<std::ranges::range_value_t<Range>> buffer,
+                Comp comp = {}, Proj proj = {}) {
+  assert(std::ranges::size(range) <= buffer.size());
+  merge_sort_impl(std::begin(range), std::end(range), buffer.begin(),
+                  projected_comp(std::move(comp), std::move(proj)));
+}
+
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void merge_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  auto buffer =
+      std::vector<std::ranges::range_value_t<Range>>(std::ranges::size(range));
+  merge_sort(range, std::span(buffer), std::move(comp), std::move(proj));
+}
+
+namespace {
+// Merge path co-ranking: the number of elements of [a, a + a_size) among the
+// first rank elements of the stable merge of [a, a + a_size) and
+// [b, b + b_size), found by binary search along the rank-th cross diagonal
+template <std::random_access_iterator AIter,
+          std::random_access_iterator BIter, typename Comp>
+size_t merge_path_split(AIter a, size_t a_size, BIter b, size_t b_size,
+                        size_t rank, Comp comp) {
+  size_t low = rank > b_size ? rank - b_size : 0;
+  size_t high = std::min(rank, a_size);
+  while (low < high) {
+    const size_t a_count = low + (high - low) / 2;
+    // Ties go to a, so a[a_count] comes first unless b's element is less
+    if (comp(b[rank - a_count - 1], a[a_count])) {
+      high = a_count;
+    } else {
+      low = a_count + 1;
+    }
+  }
+  return low;
+}
+
+// Splits the output of the merge into segment_count equal parts, whose
+// inputs are found by merge_path_split, and merges them as tasks on pool
+template <std::random_access_iterator AIter,
+          std::random_access_iterator BIter,
+          std::random_access_iterator DstIter, typename Comp>
+void parallel_merge(AIter a, size_t a_size, BIter b, size_t b_size,
+                    DstIter dst, thread_pool &pool, size_t segment_count,
+                    Comp comp) {
+  const size_t size = a_size + b_size;
+  auto merge_segment = [=](size_t segment) {
+    const size_t begin = size * segment / segment_count;
+    const size_t end = size * (segment + 1) / segment_count;
+    const size_t a_begin = merge_path_split(a, a_size, b, b_size, begin, comp);
+    const size_t a_end = merge_path_split(a, a_size, b, b_size, end, comp);
+    std::merge(std::make_move_iterator(a + a_begin),
+               std::make_move_iterator(a + a_end),
+               std::make_move_iterator(b + (begin - a_begin)),
+               std::make_move_iterator(b + (end - a_end)), dst + begin,
+               comp);
+  };
+
+  auto group = task_group(pool);
+  for (size_t segment = 1; segment < segment_count; ++segment) {
+    group.run([&merge_segment, segment] { merge_segment(segment); });
+  }
+  merge_segment(0);
+  group.wait();
+}
+
+// Sorts the size elements at begin into begin, or into buffer if
+// into_buffer. The halves are sorted into the other one as parallel tasks,
+// then merged back in parallel.
+template <std::random_access_iterator Iter,
+          std::random_access_iterator BufferIter, typename Comp>
+void parallel_merge_sort_impl(Iter begin, BufferIter buffer, size_t size,
+                              bool into_buffer, thread_pool &pool,
+                              size_t cutoff, Comp comp) {
+  if (size <= cutoff) {
+    merge_sort_impl(begin, begin + size, buffer, comp);
+    if (into_buffer) {
+      std::move(begin, begin + size, buffer);
+    }
     return;
   }
 
-  const auto middle = std::next(begin, size / 2);
-  merge_sort_impl(begin, middle);
-  merge_sort_impl(middle, end);
+  const size_t half = size / 2;
+  {
+    auto group = task_group(pool);
+    group.run([begin, buffer, half, into_buffer, &pool, cutoff, comp] {
+      parallel_merge_sort_impl(begin, buffer, half, !into_buffer, pool,
+                               cutoff, comp);
+    });
+    parallel_merge_sort_impl(begin + half, buffer + half, size - half,
+                             !into_buffer, pool, cutoff, comp);
+    group.wait();
+  }
 
-  std::inplace_merge(begin, middle, end);
+  // The caller helps, so one segment more than there are workers
+  const size_t segment_count = std::min(size / cutoff, pool.size() + 1);
+  if (into_buffer) {
+    parallel_merge(begin, half, begin + half, size - half, buffer, pool,
+                   segment_count, comp);
+  } else {
+    parallel_merge(buffer, half, buffer + half, size - half, begin, pool,
+                   segment_count, comp);
+  }
 }
 } // namespace
 
-template <std::ranges::random_access_range Range>
-void merge_sort(Range &range) {
-  merge_sort_impl(std::begin(range), std::end(range));
+// Stable. Halves are sorted as tasks on pool, which is reused across calls,
+// and each merge is split into disjoint output segments that are merged at
+// the same time; ranges of at most cutoff elements are sorted serially
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void parallel_merge_sort(Range &&range, thread_pool &pool,
+                         size_t cutoff = 1 << 13, Comp comp = {},
+                         Proj proj = {}) {
+  const size_t size = std::ranges::size(range);
+  auto buffer = std::vector<std::ranges::range_value_t<Range>>(size);
+  parallel_merge_sort_impl(std::begin(range), buffer.begin(), size, false,
+                           pool, std::max<size_t>(cutoff, 1),
+                           projected_comp(std::move(comp), std::move(proj)));
+}
+
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void parallel_merge_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  parallel_merge_sort(range, default_thread_pool(), 1 << 13, std::move(comp),
+                      std::move(proj));
 }
 
-} // namespace sorting
\ No newline at end of file
+} // namespace sorting
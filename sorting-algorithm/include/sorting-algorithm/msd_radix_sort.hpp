@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include <sorting-algorithm/radix_sort.hpp>
+#include <sorting-algorithm/sorting_network.hpp>
+
+namespace sorting {
+
+namespace {
+template <std::random_access_iterator Iter, typename KeyFn>
+void msd_insert_sort(Iter begin, Iter end, KeyFn key) {
+  if (begin == end) {
+    return;
+  }
+  for (auto iter = begin + 1; iter != end; ++iter) {
+    auto value = std::move(*iter);
+    const auto value_key = key(value);
+
+    auto pos = iter;
+    for (; pos != begin && value_key < key(*(pos - 1)); --pos) {
+      *pos = std::move(*(pos - 1));
+    }
+    *pos = std::move(value);
+  }
+}
+
+// American flag sort: counts the digit at shift, permutes every element into
+// its bucket in place by following swap cycles, then recurses on each bucket
+// with the next lower digit. Only the two count tables of each level are
+// extra memory. IsValueKey says the elements are their own keys, so that
+// small buckets can go to a sorting network.
+template <bool IsValueKey, std::random_access_iterator Iter, typename KeyFn>
+void msd_radix_sort_impl(Iter begin, Iter end, KeyFn key, size_t shift) {
+  constexpr size_t BucketBit = 8;
+  constexpr size_t BaseMask = (1 << BucketBit) - 1;
+  constexpr size_t BucketSize = 1 << BucketBit;
+  // Below this size the per-level count tables cost more than they save
+  constexpr std::ptrdiff_t InsertSortSize = 32;
+  // A sorting network in SIMD registers still does at this size
+  constexpr std::ptrdiff_t NetworkSortSize = 64;
+
+  const auto size = std::distance(begin, end);
+  // Without the network small_sort would insert by <, which orders -0.0, 0.0
+  // and NaNs differently from their radix keys
+  const bool is_network = IsValueKey && has_simd_small_sort<Iter>();
+  if (size <= (is_network ? NetworkSortSize : InsertSortSize)) {
+    if constexpr (IsValueKey) {
+      if (is_network) {
+        small_sort(begin, end);
+        return;
+      }
+    }
+    msd_insert_sort(begin, end, key);
+    return;
+  }
+
+  auto digit = [&key, &shift](const auto &x) {
+    return static_cast<size_t>((key(x) >> shift) & BaseMask);
+  };
+
+  auto bucket = std::array<size_t, BucketSize>();
+  while (true) {
+    std::fill(bucket.begin(), bucket.end(), 0);
+    for (auto iter = begin; iter != end; ++iter) {
+      bucket[digit(*iter)] += 1;
+    }
+
+    // Every element shares this digit, so go straight to the next one
+    if (std::ranges::find(bucket, static_cast<size_t>(size)) == bucket.end()) {
+      break;
+    }
+    if (shift == 0) {
+      return;
+    }
+    shift -= BucketBit;
+  }
+
+  auto head = std::array<size_t, BucketSize>();
+  auto tail = std::array<size_t, BucketSize>();
+  size_t offset = 0;
+  for (size_t b = 0; b < BucketSize; ++b) {
+    head[b] = offset;
+    offset += bucket[b];
+    tail[b] = offset;
+  }
+
+  for (size_t b = 0; b < BucketSize; ++b) {
+    while (head[b] < tail[b]) {
+      auto d = digit(begin[head[b]]);
+      while (d != b) {
+        std::iter_swap(begin + head[b], begin + head[d]++);
+        d = digit(begin[head[b]]);
+      }
+      ++head[b];
+    }
+  }
+
+  if (shift == 0) {
+    return;
+  }
+  for (size_t b = 0; b < BucketSize; ++b) {
+    const auto bucket_begin = begin + (tail[b] - bucket[b]);
+    msd_radix_sort_impl<IsValueKey>(bucket_begin, begin + tail[b], key,
+                                    shift - BucketBit);
+  }
+}
+} // namespace
+
+// In-place MSD radix sort by the key proj(x), which must be an integer or an
+// IEEE float (ordered as in radix_sort). Needs O(1) extra memory per key byte
+// instead of the scratch buffer of radix_sort, but is not stable.
+template <std::ranges::random_access_range Range, typename Proj>
+  requires std::invocable<Proj &, std::ranges::range_reference_t<Range>>
+void msd_radix_sort(Range &range, Proj proj) {
+  using IterT = decltype(std::begin(range));
+  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+  using KeyT =
+      std::remove_cvref_t<std::invoke_result_t<Proj &, const ValueT &>>;
+
+  static_assert(radix_key_type<KeyT>);
+
+  // The sorting network orders floats by their radix keys as well
+  constexpr bool IsValueKey =
+      std::same_as<Proj, std::identity> && sorting_network_type<ValueT>;
+  msd_radix_sort_impl<IsValueKey>(
+      std::begin(range), std::end(range),
+      [&proj](const ValueT &x) {
+        return radix_key<KeyT>(std::invoke(proj, x));
+      },
+      sizeof(KeyT) * 8 - 8);
+}
+
+template <std::ranges::random_access_range Range>
+void msd_radix_sort(Range &range) {
+  msd_radix_sort(range, std::identity());
+}
+
+} // namespace sorting
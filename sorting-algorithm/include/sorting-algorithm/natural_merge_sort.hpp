@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include <sorting-algorithm/comparator.hpp>
+
+namespace sorting {
+
+namespace {
+// Returns the end of the run starting at begin. A strictly descending run is
+// reversed in place; it must be strict so that reversing keeps equal elements
+// in order.
+template <std::random_access_iterator Iter, typename Comp>
+Iter natural_run_end(Iter begin, Iter end, Comp &comp) {
+  auto iter = begin + 1;
+  if (iter == end) {
+    return end;
+  }
+  if (comp(*iter, *begin)) {
+    do {
+      ++iter;
+    } while (iter != end && comp(*iter, *(iter - 1)));
+    std::reverse(begin, iter);
+  } else {
+    do {
+      ++iter;
+    } while (iter != end && !comp(*iter, *(iter - 1)));
+  }
+  return iter;
+}
+
+// Inserts [sorted_end, end) one by one into the sorted [begin, sorted_end)
+template <std::random_access_iterator Iter, typename Comp>
+void binary_insert_sort(Iter begin, Iter sorted_end, Iter end, Comp &comp) {
+  for (auto iter = sorted_end; iter != end; ++iter) {
+    auto value = std::move(*iter);
+    const auto pos = std::upper_bound(begin, iter, value, comp);
+    std::move_backward(pos, iter, iter + 1);
+    *pos = std::move(value);
+  }
+}
+
+// Length below which a natural run is extended by insertion sort. Lies in
+// [32, 64] and makes size / min_run close to, but not above, a power of two.
+inline size_t natural_min_run(size_t size) {
+  size_t has_rest = 0;
+  while (size >= 64) {
+    has_rest |= size & 1;
+    size >>= 1;
+  }
+  return size + has_rest;
+}
+
+// Powersort merge priority of the boundary between the neighbouring runs
+// [begin1, end1) and [end1, end2) of a size-element range: the depth at which
+// a perfectly balanced merge tree would split between their midpoints
+inline size_t natural_run_power(size_t begin1, size_t end1, size_t end2,
+                                size_t size) {
+  // Twice the midpoints, so that they stay integral
+  size_t a = begin1 + end1;
+  size_t b = end1 + end2;
+  size_t power = 0;
+  while (true) {
+    ++power;
+    if (a >= size) {
+      a -= size;
+      b -= size;
+    } else if (b >= size) {
+      return power;
+    }
+    a <<= 1;
+    b <<= 1;
+  }
+}
+
+// Exponential search from begin for the first element that is greater than
+// value (or, with Comp flipped by the caller, not less)
+template <std::random_access_iterator Iter, typename T, typename Comp>
+Iter gallop_upper(Iter begin, Iter end, const T &value, Comp comp) {
+  const auto size = static_cast<size_t>(end - begin);
+  size_t bound = 1;
+  while (bound < size && !comp(value, begin[bound])) {
+    bound *= 2;
+  }
+  return std::upper_bound(begin + bound / 2, begin + std::min(bound, size),
+                          value, comp);
+}
+
+template <std::random_access_iterator Iter, typename T, typename Comp>
+Iter gallop_lower(Iter begin, Iter end, const T &value, Comp comp) {
+  const auto size = static_cast<size_t>(end - begin);
+  size_t bound = 1;
+  while (bound < size && comp(begin[bound], value)) {
+    bound *= 2;
+  }
+  return std::lower_bound(begin + bound / 2, begin + std::min(bound, size),
+                          value, comp);
+}
+
+// Merges the run moved out to [buffer, buffer_end) with the run [right, end)
+// into [dest, end), where dest is right minus the buffered length. Ties go to
+// the buffered run. Once one side wins min_gallop times in a row, galloping
+// copies whole blocks found by exponential search; min_gallop adapts to how
+// well that pays off.
+template <std::random_access_iterator BufferIter,
+          std::random_access_iterator Iter, typename Comp>
+void gallop_merge(BufferIter buffer, BufferIter buffer_end, Iter right,
+                  Iter end, Iter dest, Comp comp) {
+  constexpr size_t MinGallop = 7;
+
+  size_t min_gallop = MinGallop;
+  while (buffer != buffer_end && right != end) {
+    size_t buffer_wins = 0;
+    size_t right_wins = 0;
+    while (buffer != buffer_end && right != end &&
+           std::max(buffer_wins, right_wins) < min_gallop) {
+      if (comp(*right, *buffer)) {
+        *dest++ = std::move(*right++);
+        ++right_wins;
+        buffer_wins = 0;
+      } else {
+        *dest++ = std::move(*buffer++);
+        ++buffer_wins;
+        right_wins = 0;
+      }
+    }
+
+    while (buffer != buffer_end && right != end) {
+      const auto buffer_stop = gallop_upper(buffer, buffer_end, *right, comp);
+      const auto buffer_count = static_cast<size_t>(buffer_stop - buffer);
+      dest = std::move(buffer, buffer_stop, dest);
+      buffer = buffer_stop;
+      if (buffer == buffer_end) {
+        break;
+      }
+
+      const auto right_stop = gallop_lower(right, end, *buffer, comp);
+      const auto right_count = static_cast<size_t>(right_stop - right);
+      dest = std::move(right, right_stop, dest);
+      right = right_stop;
+
+      if (buffer_count < MinGallop && right_count < MinGallop) {
+        ++min_gallop;
+        break;
+      }
+      min_gallop -= min_gallop > 1 ? 1 : 0;
+    }
+  }
+  // Whatever is left of [right, end) is already in place
+  std::move(buffer, buffer_end, dest);
+}
+
+// Stably merges the sorted [begin, middle) and [middle, end), moving only the
+// shorter run out to buffer
+template <std::random_access_iterator Iter,
+          std::random_access_iterator BufferIter, typename Comp>
+void natural_merge(Iter begin, Iter middle, Iter end, BufferIter buffer,
+                   Comp &comp) {
+  // The prefix of the left run and the suffix of the right run that are
+  // already in place do not take part
+  begin = std::upper_bound(begin, middle, *middle, comp);
+  if (begin == middle) {
+    return;
+  }
+  end = std::lower_bound(middle, end, *(middle - 1), comp);
+
+  const auto left_size = static_cast<size_t>(middle - begin);
+  const auto right_size = static_cast<size_t>(end - middle);
+  const auto less = [&comp](const auto &x, const auto &y) {
+    return comp(x, y);
+  };
+  if (left_size <= right_size) {
+    const auto buffer_end = std::move(begin, begin + left_size, buffer);
+    gallop_merge(buffer, buffer_end, middle, end, begin, less);
+  } else {
+    // Merging backwards is merging the reversed runs forwards with the order
+    // flipped, which also sends ties to the buffered right run
+    const auto buffer_end = std::move(middle, middle + right_size, buffer);
+    const auto greater = [&comp](const auto &x, const auto &y) {
+      return comp(y, x);
+    };
+    gallop_merge(std::make_reverse_iterator(buffer_end),
+                 std::make_reverse_iterator(buffer),
+                 std::make_reverse_iterator(middle),
+                 std::make_reverse_iterator(begin),
+                 std::make_reverse_iterator(end), greater);
+  }
+}
+
+// Powersort: finds natural runs left to right, extends short ones to
+// natural_min_run by insertion sort, and merges neighbouring runs on a stack
+// in the order given by natural_run_power. Sorted or reversed input is a
+// single run and costs n - 1 comparisons.
+template <std::random_access_iterator Iter, typename Comp>
+void natural_merge_sort_impl(Iter begin, Iter end, Comp comp) {
+  using ValueT = std::iter_value_t<Iter>;
+
+  struct natural_run {
+    size_t begin;
+    size_t end;
+    // Merge priority of the boundary with the run above it on the stack
+    size_t power;
+  };
+
+  const auto size = static_cast<size_t>(std::ranges::distance(begin, end));
+  if (size < 2) {
+    return;
+  }
+  const size_t min_run = natural_min_run(size);
+
+  // Powers grow strictly up the stack, so it never gets deeper than this
+  constexpr size_t MaxRunCount = std::numeric_limits<size_t>::digits + 1;
+
+  auto runs = std::array<natural_run, MaxRunCount>();
+  size_t run_count = 0;
+  auto buffer = std::vector<ValueT>();
+
+  auto merge_top = [&]() {
+    auto &left = runs[run_count - 2];
+    const auto &right = runs[run_count - 1];
+    if (buffer.empty()) {
+      buffer.resize(size / 2);
+    }
+    natural_merge(begin + left.begin, begin + left.end, begin + right.end,
+                  buffer.begin(), comp);
+    left.end = right.end;
+    --run_count;
+  };
+
+  for (size_t run_begin = 0; run_begin < size;) {
+    auto run_end = static_cast<size_t>(
+        natural_run_end(begin + run_begin, end, comp) - begin);
+    if (run_end - run_begin < min_run) {
+      const size_t forced_end = std::min(run_begin + min_run, size);
+      binary_insert_sort(begin + run_begin, begin + run_end,
+                         begin + forced_end, comp);
+      run_end = forced_end;
+    }
+
+    if (run_count > 0) {
+      const auto &top = runs[run_count - 1];
+      const size_t power =
+          natural_run_power(top.begin, top.end, run_end, size);
+      while (run_count > 1 && runs[run_count - 2].power > power) {
+        merge_top();
+      }
+      runs[run_count - 1].power = power;
+    }
+    runs[run_count++] = {run_begin, run_end, 0};
+    run_begin = run_end;
+  }
+
+  while (run_count > 1) {
+    merge_top();
+  }
+}
+} // namespace
+
+// Stable merge sort that adapts to existing order: close to O(n) on sorted,
+// reversed or nearly sorted input and O(n log n) otherwise, with a buffer of
+// at most half the range allocated only if runs need merging
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void natural_merge_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  natural_merge_sort_impl(std::begin(range), std::end(range),
+                          projected_comp(std::move(comp), std::move(proj)));
+}
+
+} // namespace sorting
@@ -1,25 +1,56 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <limits>
 #include <ranges>
+#include <tuple>
+#include <utility>
+
+#include <sorting-algorithm/comparator.hpp>
+#include <sorting-algorithm/heap_sort.hpp>
+#include <sorting-algorithm/insert_sort.hpp>
+#include <sorting-algorithm/simd_partition.hpp>
+#include <sorting-algorithm/sorting_network.hpp>
+#include <sorting-algorithm/thread_pool.hpp>
 
 namespace sorting {
 
+// Partition step used by quick_sort
+enum class partition_kernel {
+  // Dutch-flag partition into <, == and > the pivot
+  three_way,
+  // Branchless block partition into < and >= the pivot (BlockQuicksort)
+  block,
+  // Block partition with the pattern handling of pdqsort: ninther pivots, an
+  // early exit on already partitioned ranges and pivot shuffling after
+  // unbalanced partitions
+  pdq,
+  // Vectorized partition into < and >= the pivot with AVX-512 or AVX2, for
+  // contiguous int32, uint32, int64 and float elements on CPUs that have
+  // either; three_way otherwise
+  simd,
+};
+
 namespace {
 // Function to find the median of three elements
-template <typename Iter> Iter median_of_three(Iter a, Iter b, Iter c) {
-  if (*a < *b) {
-    if (*b < *c) {
+template <typename Iter, typename Comp>
+Iter median_of_three(Iter a, Iter b, Iter c, Comp &comp) {
+  if (comp(*a, *b)) {
+    if (comp(*b, *c)) {
       return b; // a < b < c
-    } else if (*a < *c) {
+    } else if (comp(*a, *c)) {
       return c; // a < c <= b
     } else {
       return a; // c <= a < b
     }
   } else { // *b <= *a
-    if (*a < *c) {
+    if (comp(*a, *c)) {
       return a; // b <= a < c
-    } else if (*b < *c) {
+    } else if (comp(*b, *c)) {
       return c; // b < c <= a
     } else {
       return b; // c <= b <= a
@@ -27,24 +58,21 @@ template <typename Iter> Iter median_of_three(Iter a, Iter b, Iter c) {
   }
 }
 
-// 3-way partitioning for quick sort
-template <std::random_access_iterator Iter>
-std::pair<Iter, Iter> partition_3way(Iter begin, Iter end) {
-  if (begin == end)
-    return {begin, begin};
-
-  // Choose pivot using median-of-three
-  Iter pivot_pos;
+// Choose pivot using median-of-three
+template <std::random_access_iterator Iter, typename Comp>
+Iter choose_pivot(Iter begin, Iter end, Comp &comp) {
   if (std::distance(begin, end) >= 3) {
     Iter mid = begin + std::distance(begin, end) / 2;
-    pivot_pos = median_of_three(begin, mid, end - 1);
+    return median_of_three(begin, mid, end - 1, comp);
   } else {
-    pivot_pos = begin;
+    return begin;
   }
+}
 
-  // Move pivot to the beginning
-  auto pivot = *pivot_pos;
-  std::iter_swap(begin, pivot_pos);
+// 3-way partitioning around the pivot at *begin
+template <std::random_access_iterator Iter, typename Comp>
+std::pair<Iter, Iter> partition_3way_at(Iter begin, Iter end, Comp &comp) {
+  auto pivot = *begin;
 
   // Three-way partitioning
   Iter lt = begin;    // Elements < pivot will be in [begin, lt)
@@ -52,11 +80,11 @@ std::pair<Iter, Iter> partition_3way(Iter begin, Iter end) {
   Iter i = begin + 1; // Current element to process
 
   while (i < gt) {
-    if (*i < pivot) {
+    if (comp(*i, pivot)) {
       std::iter_swap(lt, i);
       ++lt;
       ++i;
-    } else if (pivot < *i) {
+    } else if (comp(pivot, *i)) {
       --gt;
       std::iter_swap(i, gt);
     } else { // *i == pivot
@@ -67,24 +95,447 @@ std::pair<Iter, Iter> partition_3way(Iter begin, Iter end) {
   return {lt, gt};
 }
 
-template <std::random_access_iterator Iter>
-void quick_sort_impl(Iter begin, Iter end) {
-  if (std::distance(begin, end) <= 1) {
-    return;
+// 3-way partitioning for quick sort
+template <std::random_access_iterator Iter, typename Comp>
+std::pair<Iter, Iter> partition_3way(Iter begin, Iter end, Comp &comp) {
+  if (begin == end)
+    return {begin, begin};
+
+  // Move pivot to the beginning
+  std::iter_swap(begin, choose_pivot(begin, end, comp));
+
+  return partition_3way_at(begin, end, comp);
+}
+
+// Block partitioning around the pivot at *begin. Returns the final position
+// of the pivot, with the elements < pivot before it and the elements >= pivot
+// after it, and whether no element had to be swapped. Each side is scanned in
+// blocks whose comparison results are stored as offsets without branching on
+// them, and the misplaced elements of both sides are then swapped pairwise.
+template <std::random_access_iterator Iter, typename Comp>
+std::pair<Iter, bool> partition_block_at(Iter begin, Iter end, Comp &comp) {
+  constexpr std::ptrdiff_t BlockSize = 64;
+
+  auto pivot = std::move(*begin);
+  bool is_partitioned = true;
+
+  Iter first = begin + 1; // Elements < pivot are in [begin + 1, first)
+  Iter last = end;        // Elements >= pivot are in [last, end)
+
+  std::array<unsigned char, BlockSize> offsets_l;
+  std::array<unsigned char, BlockSize> offsets_r;
+  std::ptrdiff_t num_l = 0, start_l = 0;
+  std::ptrdiff_t num_r = 0, start_r = 0;
+
+  while (std::distance(first, last) >= 2 * BlockSize) {
+    if (num_l == 0) {
+      start_l = 0;
+      for (std::ptrdiff_t i = 0; i < BlockSize; ++i) {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !comp(first[i], pivot);
+      }
+    }
+    if (num_r == 0) {
+      start_r = 0;
+      for (std::ptrdiff_t i = 1; i <= BlockSize; ++i) {
+        offsets_r[num_r] = static_cast<unsigned char>(i);
+        num_r += comp(*(last - i), pivot);
+      }
+    }
+
+    const auto num = std::min(num_l, num_r);
+    is_partitioned &= (num == 0);
+    for (std::ptrdiff_t k = 0; k < num; ++k) {
+      std::iter_swap(first + offsets_l[start_l + k],
+                     last - offsets_r[start_r + k]);
+    }
+    num_l -= num;
+    num_r -= num;
+    start_l += num;
+    start_r += num;
+
+    if (num_l == 0) {
+      first += BlockSize;
+    }
+    if (num_r == 0) {
+      last -= BlockSize;
+    }
   }
 
-  // Partition the range
-  auto [lt, gt] = partition_3way(begin, end);
+  // Fewer than two blocks are left; partition them classically, which also
+  // settles the block whose misplaced elements did not all get swapped
+  while (true) {
+    while (first < last && comp(*first, pivot)) {
+      ++first;
+    }
+    while (first < last && !comp(*(last - 1), pivot)) {
+      --last;
+    }
+    if (first == last) {
+      break;
+    }
+    is_partitioned = false;
+    std::iter_swap(first, last - 1);
+    ++first;
+    --last;
+  }
+
+  Iter pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, is_partitioned};
+}
+
+template <std::random_access_iterator Iter, typename Comp>
+void sort2(Iter a, Iter b, Comp &comp) {
+  if (comp(*b, *a)) {
+    std::iter_swap(a, b);
+  }
+}
 
-  // Recursively sort the partitions
-  quick_sort_impl(begin, lt);
-  quick_sort_impl(gt, end);
+// Sorts three elements, leaving their median in b
+template <std::random_access_iterator Iter, typename Comp>
+void sort3(Iter a, Iter b, Iter c, Comp &comp) {
+  sort2(a, b, comp);
+  sort2(b, c, comp);
+  sort2(a, b, comp);
+}
+
+// Moves the pivot to *begin: the median of three elements, or above
+// pdq_ninther_size Tukey's ninther
+inline constexpr std::ptrdiff_t pdq_ninther_size = 128;
+
+template <std::random_access_iterator Iter, typename Comp>
+void move_pdq_pivot(Iter begin, Iter end, Comp &comp) {
+  const auto size = std::distance(begin, end);
+  const auto half = size / 2;
+  if (size > pdq_ninther_size) {
+    sort3(begin, begin + half, end - 1, comp);
+    sort3(begin + 1, begin + (half - 1), end - 2, comp);
+    sort3(begin + 2, begin + (half + 1), end - 3, comp);
+    sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+    std::iter_swap(begin, begin + half);
+  } else {
+    sort3(begin + half, begin, end - 1, comp);
+  }
+}
+
+// Insertion sort that gives up once it has moved more than move_limit
+// elements. Returns whether the range ended up sorted.
+template <std::random_access_iterator Iter, typename Comp>
+bool partial_insert_sort(Iter begin, Iter end, std::ptrdiff_t move_limit,
+                         Comp &comp) {
+
+  if (begin == end) {
+    return true;
+  }
+
+  std::ptrdiff_t move_count = 0;
+  for (auto iter = begin + 1; iter != end; ++iter) {
+    if (!comp(*iter, *(iter - 1))) {
+      continue;
+    }
+
+    auto value = std::move(*iter);
+    auto pos = iter;
+    do {
+      *pos = std::move(*(pos - 1));
+      --pos;
+    } while (pos != begin && comp(value, *(pos - 1)));
+    *pos = std::move(value);
+
+    move_count += std::distance(pos, iter);
+    if (move_count > move_limit) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Pattern-defeating quicksort (Orson Peters). Sorted and reverse sorted
+// inputs are finished in linear time by the early exit, and each highly
+// unbalanced partition costs one of bad_allowed before heap sort takes over.
+// Unless is_leftmost, *(begin - 1) is not greater than any element of the
+// range.
+template <std::random_access_iterator Iter, typename Comp>
+void pdq_sort_impl(Iter begin, Iter end, size_t bad_allowed, Comp &comp,
+                   bool is_leftmost = true) {
+  // Below this size insertion sort beats another partition
+  constexpr std::ptrdiff_t InsertSortSize = 24;
+  // Moves the early exit may spend on an already partitioned range
+  constexpr std::ptrdiff_t PartialMoveLimit = 8;
+
+  while (true) {
+    const auto size = std::distance(begin, end);
+    if (size <= InsertSortSize) {
+      // Linear rather than binary insertion, as small ranges of nearly sorted
+      // input need few moves
+      partial_insert_sort(begin, end,
+                          std::numeric_limits<std::ptrdiff_t>::max(), comp);
+      return;
+    }
+
+    move_pdq_pivot(begin, end, comp);
+
+    // The pivot equals the element before the range, so every element equal
+    // to it is already in place
+    if (!is_leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_3way_at(begin, end, comp).second;
+      continue;
+    }
+
+    const auto [pivot_pos, is_partitioned] =
+        partition_block_at(begin, end, comp);
+    const auto l_size = std::distance(begin, pivot_pos);
+    const auto r_size = std::distance(pivot_pos + 1, end);
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        heap_sort_impl<2>(begin, static_cast<size_t>(size), comp);
+        return;
+      }
+
+      // Swap a few elements around to break the pattern that caused it
+      if (l_size >= InsertSortSize) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > pdq_ninther_size) {
+          std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= InsertSortSize) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+        if (r_size > pdq_ninther_size) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(end - 2, end - (1 + r_size / 4));
+          std::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (is_partitioned &&
+               partial_insert_sort(begin, pivot_pos, PartialMoveLimit, comp) &&
+               partial_insert_sort(pivot_pos + 1, end, PartialMoveLimit,
+                                   comp)) {
+      // The partition moved nothing, and both sides needed only a few moves
+      return;
+    }
+
+    // Recursively sort the smaller partition and loop on the larger one
+    if (l_size < r_size) {
+      pdq_sort_impl(begin, pivot_pos, bad_allowed, comp, is_leftmost);
+      begin = pivot_pos + 1;
+      is_leftmost = false;
+    } else {
+      pdq_sort_impl(pivot_pos + 1, end, bad_allowed, comp, false);
+      end = pivot_pos;
+    }
+  }
+}
+
+// Number of partitioning levels after which a range is heap sorted instead
+inline size_t quick_sort_depth_limit(size_t size) {
+  return 2 * static_cast<size_t>(std::bit_width(size));
+}
+
+// Introsort: partitions until depth_limit levels have been used up, then falls
+// back to heap sort, and leaves small ranges to insertion sort. Only the
+// smaller partition is recursed into, so the stack depth stays O(log n).
+// Unless is_leftmost, *(begin - 1) is not greater than any element of the
+// range.
+template <partition_kernel Kernel = partition_kernel::three_way,
+          std::random_access_iterator Iter, typename Comp>
+void quick_sort_impl(Iter begin, Iter end, size_t depth_limit, Comp &comp,
+                     bool is_leftmost = true) {
+  // Below this size insertion sort beats another partition
+  constexpr std::ptrdiff_t InsertSortSize = 16;
+  // A sorting network in SIMD registers still does at this size
+  constexpr std::ptrdiff_t NetworkSortSize = 64;
+
+  // The sorting network only knows the default order
+  constexpr bool IsNetworkOrder =
+      is_default_less<Comp, std::iter_value_t<Iter>>;
+
+  const auto small_sort_size = IsNetworkOrder && has_simd_small_sort<Iter>()
+                                   ? NetworkSortSize
+                                   : InsertSortSize;
+  while (true) {
+    const auto size = std::distance(begin, end);
+    if (size <= small_sort_size) {
+      if constexpr (IsNetworkOrder) {
+        small_sort(begin, end);
+      } else {
+        insert_sort_impl(begin, end, comp);
+      }
+      return;
+    }
+    if (depth_limit == 0) {
+      heap_sort_impl<2>(begin, static_cast<size_t>(size), comp);
+      return;
+    }
+    --depth_limit;
+
+    std::iter_swap(begin, choose_pivot(begin, end, comp));
+    // A pivot equal to the element before the range repeats an earlier
+    // pivot, which is a sign of many duplicates: partition 3-way so that the
+    // equal keys drop out of both recursions
+    const bool is_three_way = Kernel == partition_kernel::three_way ||
+                              (!is_leftmost && !comp(*(begin - 1), *begin));
+
+    // Partition the range into [begin, lt) and [gt, end)
+    Iter lt, gt;
+    if (is_three_way) {
+      std::tie(lt, gt) = partition_3way_at(begin, end, comp);
+    } else {
+      lt = partition_block_at(begin, end, comp).first;
+      gt = lt + 1;
+    }
+
+    // Recursively sort the smaller partition and loop on the larger one
+    if (std::distance(begin, lt) < std::distance(gt, end)) {
+      quick_sort_impl<Kernel>(begin, lt, depth_limit, comp, is_leftmost);
+      begin = gt;
+      is_leftmost = false;
+    } else {
+      quick_sort_impl<Kernel>(gt, end, depth_limit, comp, false);
+      end = lt;
+    }
+  }
+}
+
+// Introsort on simd_partition, which leaves keys equal to the pivot on the
+// right. A range in which the pivot is the least key is partitioned again
+// into the keys equal to it, which are done, and the greater ones. Keys are
+// ordered as in radix_sort.
+template <std::contiguous_iterator Iter>
+void simd_quick_sort_impl(Iter begin, Iter end, size_t depth_limit) {
+  constexpr std::ptrdiff_t NetworkSortSize = sorting_network_max_size;
+
+  auto less = std::less<>();
+  while (true) {
+    const auto size = std::distance(begin, end);
+    if (size <= NetworkSortSize) {
+      small_sort(begin, end);
+      return;
+    }
+    if (depth_limit == 0) {
+      heap_sort_impl<2>(begin, static_cast<size_t>(size), less);
+      return;
+    }
+    --depth_limit;
+
+    // The partitions are stored in an order that can defeat a median of
+    // three, so the pivot is Tukey's ninther of evenly spaced samples
+    const auto step = size / 8;
+    auto a = median_of_three(begin, begin + step, begin + 2 * step, less);
+    auto b = median_of_three(begin + 3 * step, begin + 4 * step,
+                             begin + 5 * step, less);
+    auto c = median_of_three(begin + 6 * step, begin + 7 * step, end - 1, less);
+    const auto pivot = *median_of_three(a, b, c, less);
+    const auto middle = simd_partition<false>(begin, end, pivot);
+    if (middle == begin) {
+      begin = simd_partition<true>(begin, end, pivot);
+      continue;
+    }
+
+    // Recursively sort the smaller partition and loop on the larger one
+    if (std::distance(begin, middle) < std::distance(middle, end)) {
+      simd_quick_sort_impl(begin, middle, depth_limit);
+      begin = middle;
+    } else {
+      simd_quick_sort_impl(middle, end, depth_limit);
+      end = middle;
+    }
+  }
 }
 } // namespace
 
-template <std::ranges::random_access_range Range>
-void quick_sort(Range &range) {
-  quick_sort_impl(std::begin(range), std::end(range));
+// Not stable. The simd kernel applies only to the default order without a
+// projection and falls back to three_way otherwise.
+template <partition_kernel Kernel = partition_kernel::three_way,
+          std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void quick_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  using IterT = decltype(std::begin(range));
+  using ValueT = std::iter_value_t<IterT>;
+  auto less = projected_comp(std::move(comp), std::move(proj));
+  if constexpr (Kernel == partition_kernel::pdq) {
+    pdq_sort_impl(std::begin(range), std::end(range),
+                  std::bit_width(std::ranges::size(range)), less);
+  } else if constexpr (Kernel == partition_kernel::simd) {
+    const auto depth_limit = quick_sort_depth_limit(std::ranges::size(range));
+    if constexpr (std::contiguous_iterator<IterT> &&
+                  sorting_network_type<ValueT> &&
+                  is_default_less<decltype(less), ValueT>) {
+      if (has_simd_partition<IterT>()) {
+        simd_quick_sort_impl(std::begin(range), std::end(range), depth_limit);
+        return;
+      }
+    }
+    quick_sort_impl<partition_kernel::three_way>(
+        std::begin(range), std::end(range), depth_limit, less);
+  } else {
+    quick_sort_impl<Kernel>(std::begin(range), std::end(range),
+                            quick_sort_depth_limit(std::ranges::size(range)),
+                            less);
+  }
+}
+
+namespace {
+// Every task shares comp, which outlives them all
+template <std::random_access_iterator Iter, typename Comp>
+void parallel_quick_sort_impl(Iter begin, Iter end, task_group &group,
+                              std::ptrdiff_t cutoff, size_t depth_limit,
+                              Comp &comp) {
+  while (std::distance(begin, end) > cutoff && depth_limit > 0) {
+    auto [lt, gt] = partition_3way(begin, end, comp);
+    --depth_limit;
+
+    // Hand the larger partition to the pool and keep partitioning the smaller
+    if (std::distance(begin, lt) > std::distance(gt, end)) {
+      group.run([begin, lt, &group, cutoff, depth_limit, &comp] {
+        parallel_quick_sort_impl(begin, lt, group, cutoff, depth_limit, comp);
+      });
+      begin = gt;
+    } else {
+      group.run([gt, end, &group, cutoff, depth_limit, &comp] {
+        parallel_quick_sort_impl(gt, end, group, cutoff, depth_limit, comp);
+      });
+      end = lt;
+    }
+  }
+
+  quick_sort_impl(begin, end, depth_limit, comp);
+}
+} // namespace
+
+// Partitions are sorted as tasks on pool, which is reused across calls;
+// partitions of at most cutoff elements are sorted serially
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void parallel_quick_sort(Range &&range, thread_pool &pool,
+                         size_t cutoff = 1 << 13, Comp comp = {},
+                         Proj proj = {}) {
+  auto less = projected_comp(std::move(comp), std::move(proj));
+  auto group = task_group(pool);
+  parallel_quick_sort_impl(std::begin(range), std::end(range), group,
+                           static_cast<std::ptrdiff_t>(cutoff),
+                           quick_sort_depth_limit(std::ranges::size(range)),
+                           less);
+  group.wait();
+}
+
+template <std::ranges::random_access_range Range,
+          typename Comp = std::less<>, typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void parallel_quick_sort(Range &&range, Comp comp = {}, Proj proj = {}) {
+  parallel_quick_sort(range, default_thread_pool(), 1 << 13, std::move(comp),
+                      std::move(proj));
 }
 
 } // namespace sorting
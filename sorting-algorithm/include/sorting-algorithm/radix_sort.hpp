@@ -1,160 +1,592 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <barrier>
+#include <bit>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <ranges>
+#include <span>
+#include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace sorting {
 
+// Digit width that lets radix_sort choose from the key and input size
+inline constexpr size_t radix_auto_digit_bit = 0;
+
+// Optional report of the work done by radix_sort
+struct radix_sort_stats {
+  // Number of digit passes the key needs
+  size_t pass_count = 0;
+  // Passes whose digit was the same for every element, so that nothing moved
+  size_t skipped_pass_count = 0;
+};
+
+// Default of the WriteCombineMinBytes parameter of radix_sort: inputs of at
+// least this many bytes are scattered through per-bucket write-combining
+// buffers, which write whole cache lines with non-temporal stores instead of
+// single elements to up to 2048 places at once. That pays off about when the
+// input and its scratch no longer fit in the cache. 0 turns them on for every
+// input and SIZE_MAX turns them off.
+inline constexpr size_t radix_write_combine_min_bytes = size_t(1) << 21;
+
 namespace {
-template <std::ranges::random_access_range Range>
-void unsigned_radix_sort(Range &range) {
-  using IterT = decltype(std::begin(range));
-  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+// Wider digits need fewer passes, but their count tables stop fitting in L1
+// and cost more to clear and prefix-sum than a small input can repay. 16-bit
+// digits are never chosen since their count tables do not fit on the stack.
+template <typename ValueT> constexpr size_t radix_digit_bit(size_t size) {
+  return (sizeof(ValueT) >= 4 && size >= (1 << 20)) ? 11 : 8;
+}
 
-  static_assert(std::is_integral_v<ValueT>);
-  static_assert(std::is_unsigned_v<ValueT>);
+// Calls fn with the digit width as a compile-time constant
+template <typename ValueT, size_t DigitBit, typename Fn>
+void with_radix_digit_bit(size_t size, Fn fn) {
+  if constexpr (DigitBit != radix_auto_digit_bit) {
+    static_assert(1 <= DigitBit && DigitBit <= 16);
+    fn(std::integral_constant<size_t, DigitBit>());
+  } else {
+    switch (radix_digit_bit<ValueT>(size)) {
+    case 11:
+      fn(std::integral_constant<size_t, 11>());
+      break;
+    default:
+      fn(std::integral_constant<size_t, 8>());
+      break;
+    }
+  }
+}
 
-  constexpr size_t BitSize = sizeof(ValueT) * 8;
-  constexpr size_t BucketBit = 4;
-  static_assert(BitSize % BucketBit == 0);
-  constexpr ValueT BaseMask = (1 << BucketBit) - 1;
-  constexpr size_t BucketSize = 1 << BucketBit;
+// Types radix_sort orders through radix_key
+template <typename T>
+concept radix_key_type =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 &&
+     (sizeof(T) == 4 || sizeof(T) == 8));
+
+// Maps x to an unsigned integer of the same width whose order is the order of
+// x. Signed integers have their sign bit flipped. Floats have their sign bit
+// flipped if positive and every bit flipped if negative, which gives the IEEE
+// 754 total order: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN. NaNs
+// therefore land at the end, or at the front if their sign bit is set.
+template <radix_key_type ValueT> constexpr auto radix_key(ValueT x) {
+  if constexpr (std::is_unsigned_v<ValueT>) {
+    return x;
+  } else if constexpr (std::is_integral_v<ValueT>) {
+    using KeyT = std::make_unsigned_t<ValueT>;
+    constexpr KeyT SignBit = KeyT(1) << (sizeof(KeyT) * 8 - 1);
+    return static_cast<KeyT>(static_cast<KeyT>(x) ^ SignBit);
+  } else {
+    using KeyT =
+        std::conditional_t<sizeof(ValueT) == 4, std::uint32_t, std::uint64_t>;
+    constexpr size_t BitSize = sizeof(KeyT) * 8;
+    constexpr KeyT SignBit = KeyT(1) << (BitSize - 1);
+    const auto bits = std::bit_cast<KeyT>(x);
+    const auto flip = static_cast<KeyT>(KeyT(0) - (bits >> (BitSize - 1)));
+    return static_cast<KeyT>(bits ^ (flip | SignBit));
+  }
+}
 
-  const auto size = std::ranges::size(range);
-  auto buffer0 = std::vector<ValueT>(size);
-  auto buffer1 = std::vector<ValueT>(size);
-  std::copy(std::begin(range), std::end(range), std::begin(buffer0));
-  for (size_t e = 0; e < BitSize / BucketBit; ++e) {
-    const auto mask = BaseMask << (e * BucketBit);
+// Count tables up to this size live on the stack, larger ones (16-bit digits)
+// on the heap
+inline constexpr size_t radix_max_stack_count_table = 1 << 17;
 
-    auto bucket = std::array<size_t, BucketSize>();
-    std::fill(bucket.begin(), bucket.end(), 0);
-    for (auto x : buffer0) {
-      bucket[(x & mask) >> (e * BucketBit)] += 1;
-    }
+template <size_t PassSize, size_t BucketSize>
+auto make_radix_count_table() {
+  using BucketT = std::array<size_t, BucketSize>;
+  if constexpr (sizeof(BucketT) * PassSize <= radix_max_stack_count_table) {
+    return std::array<BucketT, PassSize>();
+  } else {
+    return std::vector<BucketT>(PassSize);
+  }
+}
 
-    auto cum_bucket = std::array<size_t, BucketSize>();
-    cum_bucket[0] = 0;
-    for (size_t i = 0; i < bucket.size() - 1; ++i) {
-      cum_bucket[i + 1] = cum_bucket[i] + bucket[i];
+// Adds the count of every BucketBit-bit digit of key(x), lowest first, over
+// [data, data + size) to counts[pass][digit]. With a single table, keys that
+// share a digit increment the same counter back to back, and each increment
+// waits for the store of the one before. Small digits are therefore counted
+// into several copies of the tables in turn, in 32 bits so that they stay in
+// L1, and the copies are added up at the end.
+template <size_t BucketBit, size_t PassSize, std::random_access_iterator Iter,
+          typename KeyFn, typename CountTable>
+void radix_count(Iter data, size_t size, KeyFn key, CountTable &counts) {
+  constexpr size_t BaseMask = (size_t(1) << BucketBit) - 1;
+  constexpr size_t BucketSize = size_t(1) << BucketBit;
+  constexpr size_t CopyCount = 4;
+  // Below this many keys adding up the copies costs more than they save
+  constexpr size_t MinCopySize = CopyCount * BucketSize * PassSize;
+  // The 32-bit copies are added up at least this often
+  constexpr size_t BlockSize = size_t(1) << 31;
+
+  auto count_into = [&key](auto &table, const auto &x) {
+    const auto k = key(x);
+    for (size_t e = 0; e < PassSize; ++e) {
+      table[e][(k >> (e * BucketBit)) & BaseMask] += 1;
     }
+  };
 
-    for (auto x : buffer0) {
-      buffer1[cum_bucket[(x & mask) >> (e * BucketBit)]++] = x;
+  if constexpr (BucketSize > 256) {
+    for (size_t i = 0; i < size; ++i) {
+      count_into(counts, data[i]);
+    }
+  } else {
+    if (size < MinCopySize) {
+      for (size_t i = 0; i < size; ++i) {
+        count_into(counts, data[i]);
+      }
+      return;
     }
 
-    buffer0.swap(buffer1);
+    // A cache line of padding keeps the same counter of different tables at
+    // different offsets modulo 4 KiB, which the store forwarding of many
+    // CPUs would otherwise mistake for a dependency
+    using CopyT =
+        std::array<std::array<uint32_t, BucketSize + 16>, PassSize>;
+    auto copies = std::array<CopyT, CopyCount>();
+    for (size_t begin = 0; begin < size; begin += BlockSize) {
+      const size_t end = std::min(begin + BlockSize, size);
+      for (auto &copy : copies) {
+        for (auto &table : copy) {
+          table.fill(0);
+        }
+      }
+
+      size_t i = begin;
+      for (; i + CopyCount <= end; i += CopyCount) {
+        for (size_t c = 0; c < CopyCount; ++c) {
+          count_into(copies[c], data[i + c]);
+        }
+      }
+      for (; i < end; ++i) {
+        count_into(copies[0], data[i]);
+      }
+
+      for (const auto &copy : copies) {
+        for (size_t e = 0; e < PassSize; ++e) {
+          for (size_t b = 0; b < BucketSize; ++b) {
+            counts[e][b] += copy[e][b];
+          }
+        }
+      }
+    }
   }
+}
 
-  std::copy(std::begin(buffer0), std::end(buffer0), std::begin(range));
+// Bytes a write-combining buffer holds: one cache line
+inline constexpr size_t radix_line_size = 64;
+
+template <typename T> struct alignas(radix_line_size) radix_line {
+  std::array<T, radix_line_size / sizeof(T)> items;
+};
+
+// One radix_line per bucket: 128 KiB at 11-bit digits, too much to add to
+// the count tables on the stack of whichever thread sorts. A sort allocates
+// it once, when its first pass is write-combined, and fills it anew on every
+// pass.
+template <typename T, size_t BucketSize>
+using radix_line_table = std::array<radix_line<T>, BucketSize>;
+
+// A pass whose keys fall into fewer buckets than this writes to few enough
+// places at once that the plain scatter keeps up
+inline constexpr size_t radix_write_combine_min_buckets = 32;
+
+// Whether the elements of the contiguous Iter can be scattered through
+// radix_line buffers with DigitBit-bit digits
+template <std::random_access_iterator Iter, size_t DigitBit>
+constexpr bool has_radix_write_combine() {
+  using T = std::iter_value_t<Iter>;
+  return std::contiguous_iterator<Iter> && std::is_trivially_copyable_v<T> &&
+         radix_line_size % sizeof(T) == 0 && DigitBit <= 11;
 }
 
-template <std::ranges::random_access_range Range>
-void signed_radix_sort(Range &range) {
-  using IterT = decltype(std::begin(range));
-  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+// Moves each of the size elements at src to dst[cum_bucket[digit(x)]++] like
+// a plain scatter, but gathers them per bucket in its line of lines first.
+// A full buffer is written with non-temporal stores, which skip reading the
+// line and keep the destination out of the cache. The first and last line of
+// a bucket may be shared with its neighbours; only its own part of those is
+// written, with plain stores.
+template <size_t BucketSize, typename T, typename CountTable, typename DigitFn>
+void radix_scatter_write_combine(const T *src, size_t size, T *dst,
+                                 CountTable &cum_bucket, DigitFn digit,
+                                 radix_line_table<T, BucketSize> &lines) {
+  constexpr size_t Lanes = radix_line_size / sizeof(T);
+
+  const auto address = reinterpret_cast<std::uintptr_t>(dst);
+  if (address % sizeof(T) != 0) {
+    for (size_t i = 0; i < size; ++i) {
+      dst[cum_bucket[digit(src[i])]++] = src[i];
+    }
+    return;
+  }
+  // Slot of dst[p] in its cache line is (p + phase) % Lanes
+  const size_t phase = address / sizeof(T) % Lanes;
+
+  const auto bucket_begin = cum_bucket;
+  for (size_t i = 0; i < size; ++i) {
+    const size_t b = digit(src[i]);
+    const size_t p = cum_bucket[b]++;
+    const size_t slot = (p + phase) % Lanes;
+    auto &line = lines[b];
+    line.items[slot] = src[i];
+    if (slot + 1 < Lanes) {
+      continue;
+    }
 
-  static_assert(std::is_integral_v<ValueT>);
-  static_assert(!std::is_unsigned_v<ValueT>);
+    if (p + 1 - bucket_begin[b] < Lanes) {
+      const size_t first = bucket_begin[b];
+      std::copy(line.items.begin() + (first + phase) % Lanes,
+                line.items.end(), dst + first);
+      continue;
+    }
+#if defined(__GNUC__) && defined(__x86_64__)
+    const auto *from = reinterpret_cast<const __m128i *>(line.items.data());
+    auto *to = reinterpret_cast<__m128i *>(dst + (p + 1 - Lanes));
+    for (size_t k = 0; k < radix_line_size / 16; ++k) {
+      _mm_stream_si128(to + k, _mm_load_si128(from + k));
+    }
+#else
+    std::copy(line.items.begin(), line.items.end(), dst + (p + 1 - Lanes));
+#endif
+  }
 
-  constexpr size_t BitSize = sizeof(ValueT) * 8;
-  constexpr size_t BucketBit = 4;
-  static_assert(BitSize % BucketBit == 0);
+  for (size_t b = 0; b < BucketSize; ++b) {
+    const size_t end = cum_bucket[b];
+    const size_t count = (end + phase) % Lanes;
+    const size_t first =
+        end - bucket_begin[b] < count ? bucket_begin[b] : end - count;
+    const auto *items = lines[b].items.data();
+    std::copy(items + (first + phase) % Lanes, items + (end + phase) % Lanes,
+              dst + first);
+  }
+#if defined(__GNUC__) && defined(__x86_64__)
+  // Orders the non-temporal stores before whatever reads dst next
+  _mm_sfence();
+#endif
+}
 
-  const auto size = std::ranges::size(range);
-  auto buffer0 = std::vector<ValueT>(size);
-  auto buffer1 = std::vector<ValueT>(size);
-  std::copy(std::begin(range), std::end(range), std::begin(buffer0));
+// Sorts [data, data + size) by the lowest KeyBit bits of key(x), DigitBit bits
+// per pass, moving the elements back and forth between data and scratch. The
+// counts of every digit are taken in a single read pass up front, and a digit
+// whose count table has a single occupied bucket is not scattered.
+template <size_t DigitBit, size_t KeyBit, size_t WriteCombineMinBytes,
+          std::random_access_iterator Iter,
+          std::random_access_iterator ScratchIter, typename KeyFn>
+void lsd_radix_sort(Iter data, ScratchIter scratch, size_t size, KeyFn key,
+                    radix_sort_stats *stats) {
+  constexpr size_t BucketBit = std::min(DigitBit, KeyBit);
+  constexpr size_t PassSize = (KeyBit + BucketBit - 1) / BucketBit;
+  constexpr size_t BaseMask = (size_t(1) << BucketBit) - 1;
+  constexpr size_t BucketSize = size_t(1) << BucketBit;
+
+  using ValueT = std::iter_value_t<Iter>;
+  constexpr bool HasWriteCombine =
+      WriteCombineMinBytes != SIZE_MAX &&
+      has_radix_write_combine<Iter, BucketBit>() &&
+      has_radix_write_combine<ScratchIter, BucketBit>();
+
+  auto buckets = make_radix_count_table<PassSize, BucketSize>();
+  radix_count<BucketBit, PassSize>(data, size, key, buckets);
+
+  using LineTable =
+      std::conditional_t<HasWriteCombine,
+                         radix_line_table<ValueT, BucketSize>,
+                         radix_line_table<char, 0>>;
+  auto lines = std::unique_ptr<LineTable>();
+  auto scatter = [&](auto src, auto dst, auto &cum_bucket, size_t shift,
+                     size_t bucket_count) {
+    if constexpr (HasWriteCombine) {
+      if (size * sizeof(ValueT) >= WriteCombineMinBytes &&
+          bucket_count >= radix_write_combine_min_buckets) {
+        if (!lines) {
+          lines = std::make_unique_for_overwrite<LineTable>();
+        }
+        radix_scatter_write_combine<BucketSize>(
+            std::to_address(src), size, std::to_address(dst), cum_bucket,
+            [&](const auto &x) { return (key(x) >> shift) & BaseMask; },
+            *lines);
+        return;
+      }
+    }
+    for (size_t i = 0; i < size; ++i) {
+      dst[cum_bucket[(key(src[i]) >> shift) & BaseMask]++] = std::move(src[i]);
+    }
+  };
 
-  for (size_t e = 0; e < (BitSize - 1) / BucketBit; ++e) {
-    constexpr ValueT BaseMask = (1 << BucketBit) - 1;
-    constexpr size_t BucketSize = 1 << BucketBit;
-    const auto mask = BaseMask << (e * BucketBit);
+  bool is_in_scratch = false;
+  for (size_t e = 0; e < PassSize; ++e) {
+    const auto shift = e * BucketBit;
 
-    auto bucket = std::array<size_t, BucketSize>();
-    std::fill(bucket.begin(), bucket.end(), 0);
-    for (auto x : buffer0) {
-      bucket[(x & mask) >> (e * BucketBit)] += 1;
+    if (stats != nullptr) {
+      stats->pass_count += 1;
+    }
+    if (std::ranges::find(buckets[e], size) != buckets[e].end()) {
+      if (stats != nullptr) {
+        stats->skipped_pass_count += 1;
+      }
+      continue;
     }
 
-    auto cum_bucket = std::array<size_t, BucketSize>();
-    cum_bucket[0] = 0;
-    for (size_t i = 0; i < bucket.size() - 1; ++i) {
-      cum_bucket[i + 1] = cum_bucket[i] + bucket[i];
+    auto &cum_bucket = buckets[e];
+    const auto bucket_count = static_cast<size_t>(
+        BucketSize - std::ranges::count(cum_bucket, size_t(0)));
+    size_t offset = 0;
+    for (auto &count : cum_bucket) {
+      offset += std::exchange(count, offset);
     }
 
-    for (auto x : buffer0) {
-      buffer1[cum_bucket[(x & mask) >> (e * BucketBit)]++] = x;
+    if (is_in_scratch) {
+      scatter(scratch, data, cum_bucket, shift, bucket_count);
+    } else {
+      scatter(data, scratch, cum_bucket, shift, bucket_count);
     }
+    is_in_scratch = !is_in_scratch;
+  }
 
-    buffer0.swap(buffer1);
+  if (is_in_scratch) {
+    std::move(scratch, scratch + size, data);
   }
+}
 
-  {
-    constexpr ValueT BaseMask = (1 << (BucketBit - 1)) - 1;
-    constexpr size_t BucketSize = 1 << (BucketBit - 1);
-    const auto mask = BaseMask << (((BitSize - 1) / BucketBit) * BucketBit);
+template <size_t DigitBit, size_t WriteCombineMinBytes,
+          std::ranges::random_access_range Range, typename ScratchT,
+          typename Proj>
+void radix_sort_impl(Range &range, std::span<ScratchT> scratch, Proj &proj,
+                     radix_sort_stats *stats) {
+  using IterT = decltype(std::begin(range));
+  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+  using KeyT =
+      std::remove_cvref_t<std::invoke_result_t<Proj &, const ValueT &>>;
 
-    auto bucket = std::array<size_t, BucketSize>();
-    std::fill(bucket.begin(), bucket.end(), 0);
-    for (auto x : buffer0) {
-      bucket[(x & mask) >> (((BitSize - 1) / BucketBit) * BucketBit)] += 1;
-    }
+  constexpr size_t BitSize = sizeof(KeyT) * 8;
 
-    auto cum_bucket = std::array<size_t, BucketSize>();
-    cum_bucket[0] = 0;
-    for (size_t i = 0; i < bucket.size() - 1; ++i) {
-      cum_bucket[i + 1] = cum_bucket[i] + bucket[i];
-    }
+  lsd_radix_sort<DigitBit, BitSize, WriteCombineMinBytes>(
+      std::begin(range), scratch.begin(), std::ranges::size(range),
+      [&proj](const ValueT &x) {
+        return radix_key<KeyT>(std::invoke(proj, x));
+      },
+      stats);
+}
+} // namespace
 
-    for (auto x : buffer0) {
-      buffer1[cum_bucket[(x & mask) >>
-                         (((BitSize - 1) / BucketBit) * BucketBit)]++] = x;
-    }
+// Sorts the elements of range by the key proj(x), which must be an integer or
+// an IEEE float, using scratch (at least as long as range) as the second
+// buffer. Nothing is allocated unless DigitBit is 16, or the input takes at
+// least WriteCombineMinBytes, which allocates one table of write-combining
+// buffers. Elements are moved as a whole through each pass and keep their
+// relative order when their keys are equal.
+template <size_t DigitBit = radix_auto_digit_bit,
+          size_t WriteCombineMinBytes = radix_write_combine_min_bytes,
+          std::ranges::random_access_range Range, typename Proj>
+  requires std::invocable<Proj &, std::ranges::range_reference_t<Range>>
+void radix_sort(Range &range,
+                std::span<std::ranges::range_value_t<Range>> scratch,
+                Proj proj, radix_sort_stats *stats = nullptr) {
+  using IterT = decltype(std::begin(range));
+  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+  using KeyT =
+      std::remove_cvref_t<std::invoke_result_t<Proj &, const ValueT &>>;
 
-    buffer0.swap(buffer1);
-  }
+  static_assert(radix_key_type<KeyT>);
+  assert(std::ranges::size(range) <= scratch.size());
 
-  {
-    auto bucket = std::array<size_t, 2>();
-    std::fill(bucket.begin(), bucket.end(), 0);
-    for (auto x : buffer0) {
-      bucket[(0 <= x)] += 1;
-    }
+  with_radix_digit_bit<KeyT, DigitBit>(
+      std::ranges::size(range), [&](auto digit_bit) {
+        radix_sort_impl<decltype(digit_bit)::value, WriteCombineMinBytes>(
+            range, scratch, proj, stats);
+      });
+}
 
-    auto cum_bucket = std::array<size_t, 2>();
-    cum_bucket[0] = 0;
-    for (size_t i = 0; i < bucket.size() - 1; ++i) {
-      cum_bucket[i + 1] = cum_bucket[i] + bucket[i];
-    }
+template <size_t DigitBit = radix_auto_digit_bit,
+          size_t WriteCombineMinBytes = radix_write_combine_min_bytes,
+          std::ranges::random_access_range Range>
+void radix_sort(Range &range,
+                std::span<std::ranges::range_value_t<Range>> scratch,
+                radix_sort_stats *stats = nullptr) {
+  radix_sort<DigitBit, WriteCombineMinBytes>(range, scratch, std::identity(),
+                                             stats);
+}
+
+// Sorts the elements of range by the key proj(x), which must be an integer or
+// an IEEE float. Elements are moved as a whole through each pass and keep
+// their relative order when their keys are equal.
+template <size_t DigitBit = radix_auto_digit_bit,
+          size_t WriteCombineMinBytes = radix_write_combine_min_bytes,
+          std::ranges::random_access_range Range, typename Proj>
+  requires std::invocable<Proj &, std::ranges::range_reference_t<Range>>
+void radix_sort(Range &range, Proj proj, radix_sort_stats *stats = nullptr) {
+  auto scratch =
+      std::vector<std::ranges::range_value_t<Range>>(std::ranges::size(range));
+  radix_sort<DigitBit, WriteCombineMinBytes>(range, std::span(scratch),
+                                             std::move(proj), stats);
+}
 
-    for (auto x : buffer0) {
-      buffer1[cum_bucket[(0 <= x)]++] = x;
+// DigitBit is the number of key bits sorted per pass (at most 16); by default
+// it is chosen from the key width and the input size. Inputs of at least
+// WriteCombineMinBytes bytes are scattered through write-combining buffers.
+// If stats is given, the pass counts of this call are added to it.
+template <size_t DigitBit = radix_auto_digit_bit,
+          size_t WriteCombineMinBytes = radix_write_combine_min_bytes,
+          std::ranges::random_access_range Range>
+void radix_sort(Range &range, radix_sort_stats *stats = nullptr) {
+  radix_sort<DigitBit, WriteCombineMinBytes>(range, std::identity(), stats);
+}
+
+namespace {
+template <size_t DigitBit, size_t WriteCombineMinBytes,
+          std::ranges::random_access_range Range>
+void parallel_radix_sort_impl(Range &range, size_t num_threads,
+                              radix_sort_stats *stats) {
+  using IterT = decltype(std::begin(range));
+  using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
+
+  constexpr size_t BitSize = sizeof(ValueT) * 8;
+  constexpr size_t BucketBit = std::min(DigitBit, BitSize);
+  constexpr size_t PassSize = (BitSize + BucketBit - 1) / BucketBit;
+  constexpr size_t BaseMask = (size_t(1) << BucketBit) - 1;
+  constexpr size_t BucketSize = size_t(1) << BucketBit;
+  constexpr bool HasWriteCombine =
+      WriteCombineMinBytes != SIZE_MAX &&
+      has_radix_write_combine<ValueT *, BucketBit>();
+
+  const auto size = std::ranges::size(range);
+  auto buffer0 = std::vector<ValueT>(size);
+  auto buffer1 = std::vector<ValueT>(size);
+  auto counts = std::vector<std::array<size_t, BucketSize>>(num_threads);
+  auto sync = std::barrier(static_cast<std::ptrdiff_t>(num_threads));
+
+  auto worker = [&](size_t t) {
+    const size_t chunk_begin = size * t / num_threads;
+    const size_t chunk_end = size * (t + 1) / num_threads;
+    const auto first = std::begin(range);
+
+    std::copy(first + chunk_begin, first + chunk_end,
+              buffer0.begin() + chunk_begin);
+
+    auto *src = buffer0.data();
+    auto *dst = buffer1.data();
+    using LineTable =
+        std::conditional_t<HasWriteCombine,
+                           radix_line_table<ValueT, BucketSize>,
+                           radix_line_table<char, 0>>;
+    auto lines = std::unique_ptr<LineTable>();
+    for (size_t e = 0; e < PassSize; ++e) {
+      const auto shift = e * BucketBit;
+      auto digit = [shift](ValueT x) {
+        return static_cast<size_t>((radix_key(x) >> shift) & BaseMask);
+      };
+
+      auto &bucket = counts[t];
+      std::fill(bucket.begin(), bucket.end(), 0);
+      auto bucket_table = std::span(&bucket, 1);
+      radix_count<BucketBit, 1>(
+          src + chunk_begin, chunk_end - chunk_begin,
+          [shift](ValueT x) { return radix_key(x) >> shift; }, bucket_table);
+      sync.arrive_and_wait();
+
+      // This thread writes bucket b after every element of a smaller bucket
+      // and after the elements of bucket b owned by lower threads
+      auto cum_bucket = std::array<size_t, BucketSize>();
+      size_t offset = 0;
+      bool is_trivial = false;
+      size_t bucket_count = 0;
+      for (size_t b = 0; b < BucketSize; ++b) {
+        const size_t bucket_begin = offset;
+        for (size_t u = 0; u < num_threads; ++u) {
+          if (u == t) {
+            cum_bucket[b] = offset;
+          }
+          offset += counts[u][b];
+        }
+        is_trivial |= (offset - bucket_begin == size);
+        bucket_count += (offset != bucket_begin);
+      }
+
+      if (t == 0 && stats != nullptr) {
+        stats->pass_count += 1;
+        stats->skipped_pass_count += is_trivial;
+      }
+
+      bool is_write_combined = false;
+      if constexpr (HasWriteCombine) {
+        if (!is_trivial && size * sizeof(ValueT) >= WriteCombineMinBytes &&
+            bucket_count >= radix_write_combine_min_buckets) {
+          if (!lines) {
+            lines = std::make_unique_for_overwrite<LineTable>();
+          }
+          radix_scatter_write_combine<BucketSize>(
+              src + chunk_begin, chunk_end - chunk_begin, dst, cum_bucket,
+              digit, *lines);
+          is_write_combined = true;
+        }
+      }
+      if (!is_trivial && !is_write_combined) {
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+          dst[cum_bucket[digit(src[i])]++] = src[i];
+        }
+      }
+      // Also keeps counts alive until every thread has read them
+      sync.arrive_and_wait();
+
+      if (!is_trivial) {
+        std::swap(src, dst);
+      }
     }
 
-    buffer0.swap(buffer1);
-  }
+    std::copy(src + chunk_begin, src + chunk_end, first + chunk_begin);
+  };
 
-  std::copy(std::begin(buffer0), std::end(buffer0), std::begin(range));
+  {
+    auto threads = std::vector<std::jthread>();
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+      threads.emplace_back(worker, t);
+    }
+    worker(0);
+  }
 }
 } // namespace
 
-template <std::ranges::random_access_range Range>
-void radix_sort(Range &range) {
+// Each pass splits the input into one chunk per thread. Every thread counts
+// its own chunk, the per-thread counts are merged into per-thread offsets by a
+// prefix sum over (bucket, thread), and the chunks are scattered concurrently.
+template <size_t DigitBit = radix_auto_digit_bit,
+          size_t WriteCombineMinBytes = radix_write_combine_min_bytes,
+          std::ranges::random_access_range Range>
+void parallel_radix_sort(
+    Range &range, size_t num_threads = std::thread::hardware_concurrency(),
+    radix_sort_stats *stats = nullptr) {
   using IterT = decltype(std::begin(range));
   using ValueT = std::remove_reference_t<decltype(*std::declval<IterT>())>;
 
-  static_assert(std::is_integral_v<ValueT>);
+  static_assert(radix_key_type<ValueT>);
 
-  if constexpr (std::is_unsigned_v<ValueT>) {
-    unsigned_radix_sort(range);
-  } else {
-    signed_radix_sort(range);
+  // Below this many elements per thread the synchronization costs more than
+  // the work it spreads
+  constexpr size_t MinChunkSize = 1 << 14;
+
+  const auto size = std::ranges::size(range);
+  num_threads = std::min(num_threads, size / MinChunkSize);
+  if (num_threads <= 1) {
+    radix_sort<DigitBit, WriteCombineMinBytes>(range, stats);
+    return;
   }
+
+  with_radix_digit_bit<ValueT, DigitBit>(size, [&](auto digit_bit) {
+    parallel_radix_sort_impl<decltype(digit_bit)::value,
+                             WriteCombineMinBytes>(range, num_threads, stats);
+  });
 }
 
-} // namespace sorting
\ No newline at end of file
+} // namespace sorting
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include <sorting-algorithm/comparator.hpp>
+#include <sorting-algorithm/heap_sort.hpp>
+#include <sorting-algorithm/insert_sort.hpp>
+#include <sorting-algorithm/quick_sort.hpp>
+
+namespace sorting {
+
+namespace {
+// Moves the middle - begin first elements of [begin, end) by comp to [begin,
+// middle) as a max-heap, so that *begin is the last of them. Each later
+// element that comes before the top replaces it with one sift, and the others
+// cost one comparison.
+template <std::random_access_iterator Iter, typename Comp>
+void heap_select(Iter begin, Iter middle, Iter end, Comp &comp) {
+  constexpr size_t Arity = 4;
+
+  const auto size = static_cast<size_t>(middle - begin);
+  heapify<Arity>(begin, size, comp);
+  for (auto iter = middle; iter != end; ++iter) {
+    if (comp(*iter, *begin)) {
+      auto value = std::move(*iter);
+      *iter = std::move(*begin);
+      sift_down<Arity>(begin, size, 0, std::move(value), comp);
+    }
+  }
+}
+
+// Introselect on the partitions of pdq_sort_impl: keeps only the part that
+// holds nth until depth_limit levels have been used up, then falls back to
+// heap_select, whose O(n log k) bounds the worst case. Unless is_leftmost,
+// *(begin - 1) is not greater than any element of the range.
+template <std::random_access_iterator Iter, typename Comp>
+void introselect_impl(Iter begin, Iter nth, Iter end, size_t depth_limit,
+                      Comp &comp, bool is_leftmost = true) {
+  // Below this size insertion sort beats another partition
+  constexpr std::ptrdiff_t InsertSortSize = 24;
+
+  while (std::distance(begin, end) > InsertSortSize) {
+    if (depth_limit == 0) {
+      heap_select(begin, nth + 1, end, comp);
+      std::iter_swap(begin, nth);
+      return;
+    }
+    --depth_limit;
+
+    move_pdq_pivot(begin, end, comp);
+    // The pivot equals the element before the range, so every element equal
+    // to it is already in place
+    if (!is_leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_3way_at(begin, end, comp).second;
+      if (nth < begin) {
+        return;
+      }
+      continue;
+    }
+
+    const auto pivot_pos = partition_block_at(begin, end, comp).first;
+    if (nth < pivot_pos) {
+      end = pivot_pos;
+    } else if (nth > pivot_pos) {
+      begin = pivot_pos + 1;
+      is_leftmost = false;
+    } else {
+      return;
+    }
+  }
+  insert_sort_impl(begin, end, comp);
+}
+
+// Places the element that comes nth by comp at nth, with none that comes
+// after it before it and none that comes before it after it
+template <std::random_access_iterator Iter, typename Comp, typename Proj>
+void select_impl(Iter begin, Iter nth, Iter end, Comp &comp, Proj &proj) {
+  if (nth == end) {
+    return;
+  }
+  auto less = projected_comp(comp, proj);
+  introselect_impl(begin, nth, end,
+                   quick_sort_depth_limit(static_cast<size_t>(end - begin)),
+                   less);
+}
+
+// k at most this fraction of the range is selected by heap_select rather
+// than partitioning
+inline constexpr size_t heap_select_max_ratio = 256;
+} // namespace
+
+// Rearranges range so that nth holds the element that would be there if range
+// were sorted by comp on proj(x), with the elements before it not after it and
+// the elements after it not before it. O(n) on average and O(n log n) at
+// worst (introselect).
+template <std::ranges::random_access_range Range, typename Comp = std::less<>,
+          typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void nth_element(Range &&range, std::ranges::iterator_t<Range> nth,
+                 Comp comp = {}, Proj proj = {}) {
+  select_impl(std::ranges::begin(range), nth, std::ranges::end(range), comp,
+              proj);
+}
+
+// Rearranges range so that [begin, middle) holds the middle - begin elements
+// that come first by comp on proj(x), in order. A few of them are found with
+// a heap of their size in one pass over the range, more with nth_element.
+// Not stable.
+template <std::ranges::random_access_range Range, typename Comp = std::less<>,
+          typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void partial_sort(Range &&range, std::ranges::iterator_t<Range> middle,
+                  Comp comp = {}, Proj proj = {}) {
+  const auto begin = std::ranges::begin(range);
+  const auto end = std::ranges::end(range);
+  const auto size = static_cast<size_t>(end - begin);
+  const auto count = static_cast<size_t>(middle - begin);
+  if (count == 0) {
+    return;
+  }
+
+  if (count * heap_select_max_ratio <= size) {
+    auto less = projected_comp(comp, proj);
+    heap_select(begin, middle, end, less);
+  } else if (middle != end) {
+    select_impl(begin, middle - 1, end, comp, proj);
+  }
+  quick_sort<partition_kernel::simd>(std::ranges::subrange(begin, middle),
+                                     std::move(comp), std::move(proj));
+}
+
+// Returns the k elements of range that come first by comp on proj(x), in
+// order, or all of them if there are fewer; range is left as it is. A few
+// are kept in a heap while range is read once, which copies only those, and
+// more are selected from a copy of range.
+template <std::ranges::random_access_range Range, typename Comp = std::less<>,
+          typename Proj = std::identity>
+  requires std::sortable<
+      std::ranges::iterator_t<std::vector<std::ranges::range_value_t<Range>>>,
+      Comp, Proj>
+std::vector<std::ranges::range_value_t<Range>>
+top_k(const Range &range, size_t k, Comp comp = {}, Proj proj = {}) {
+  using ValueT = std::ranges::range_value_t<Range>;
+  constexpr size_t Arity = 4;
+
+  const auto begin = std::ranges::begin(range);
+  const auto size = static_cast<size_t>(std::ranges::size(range));
+  k = std::min(k, size);
+  if (k == 0) {
+    return {};
+  }
+
+  auto top = std::vector<ValueT>();
+  if (k * heap_select_max_ratio <= size) {
+    auto less = projected_comp(comp, proj);
+    top.assign(begin, begin + k);
+    heapify<Arity>(top.begin(), k, less);
+    for (size_t i = k; i < size; ++i) {
+      if (less(begin[i], top.front())) {
+        sift_down<Arity>(top.begin(), k, 0, ValueT(begin[i]), less);
+      }
+    }
+  } else {
+    top.assign(begin, begin + size);
+    if (k < size) {
+      select_impl(top.begin(), top.begin() + k, top.end(), comp, proj);
+    }
+    top.resize(k);
+  }
+  quick_sort<partition_kernel::simd>(top, std::move(comp), std::move(proj));
+  return top;
+}
+
+} // namespace sorting
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+#include <sorting-algorithm/radix_sort.hpp>
+#include <sorting-algorithm/sorting_network.hpp>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sorting {
+
+// As in sorting_network.hpp, the generic code passes vectors by value but is
+// only ever inlined, always_inline also without optimization, into the entry
+// points compiled for the ISA
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace {
+// In-place vectorized partition (as in vqsort and x86-simd-sort). One vector
+// from each end is held in registers, which leaves two vectors of room to
+// store into. Every further vector is read from the side with less room left,
+// split by a compare into the elements that stay left and those that go
+// right, and stored to both ends of the room at once. The room stays two
+// vectors wide, at least one on each side, so no store touches unread
+// elements. Returns where the elements that go right start.
+template <typename Ops, bool IsGreater>
+[[gnu::always_inline]] inline typename Ops::value_type *
+simd_partition_block(typename Ops::value_type *begin,
+                     typename Ops::value_type *end,
+                     typename Ops::value_type pivot) {
+  using T = typename Ops::value_type;
+  constexpr std::ptrdiff_t Lanes = Ops::lanes;
+
+  const auto pivot_key = Ops::broadcast(pivot);
+  const auto first = Ops::load(begin);
+  const auto last = Ops::load(end - Lanes);
+
+  // Unread elements are in [read_begin, read_end), stored ones in
+  // [begin, store_begin) and [store_end, end)
+  T *read_begin = begin + Lanes;
+  T *read_end = end - Lanes;
+  T *store_begin = begin;
+  T *store_end = end;
+
+  while (read_end - read_begin >= Lanes) {
+    if (read_begin - store_begin <= store_end - read_end) {
+      const auto v = Ops::load(read_begin);
+      read_begin += Lanes;
+      Ops::template partition_store<IsGreater>(v, pivot_key, store_begin,
+                                               store_end);
+    } else {
+      read_end -= Lanes;
+      Ops::template partition_store<IsGreater>(Ops::load(read_end), pivot_key,
+                                               store_begin, store_end);
+    }
+  }
+
+  // Fewer than a vector is left, which goes one by one
+  const auto pivot_radix_key = radix_key(pivot);
+  while (read_begin != read_end) {
+    const T value = read_begin - store_begin <= store_end - read_end
+                        ? *read_begin++
+                        : *--read_end;
+    const bool goes_right = IsGreater ? pivot_radix_key < radix_key(value)
+                                      : !(radix_key(value) < pivot_radix_key);
+    if (goes_right) {
+      *--store_end = value;
+    } else {
+      *store_begin++ = value;
+    }
+  }
+
+  Ops::template partition_store<IsGreater>(first, pivot_key, store_begin,
+                                           store_end);
+  Ops::template partition_store<IsGreater>(last, pivot_key, store_begin,
+                                           store_end);
+  return store_begin;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// For every mask of the lanes that go right, the 32-bit lane indices that
+// move the other lanes to the front and those to the back, both in order
+template <size_t Lanes> constexpr auto make_partition_permutations() {
+  constexpr size_t Width = 8 / Lanes;
+  auto permutations = std::array<std::array<int32_t, 8>, (1 << Lanes)>();
+  for (size_t mask = 0; mask < permutations.size(); ++mask) {
+    size_t left = 0;
+    size_t right = Lanes - static_cast<size_t>(std::popcount(mask));
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      auto &to = ((mask >> lane) & 1) ? right : left;
+      for (size_t i = 0; i < Width; ++i) {
+        permutations[mask][to * Width + i] =
+            static_cast<int32_t>(lane * Width + i);
+      }
+      ++to;
+    }
+  }
+  return permutations;
+}
+
+template <size_t Lanes>
+constexpr auto partition_permutations = make_partition_permutations<Lanes>();
+
+// Keys are compared as signed integers: unsigned ones with their sign bit
+// flipped, floats with all but the sign bit flipped if negative. That is the
+// order of radix_key, and each flip is its own inverse.
+
+// Elements in an AVX2 register. Without a compress store, the vector is
+// permuted so that the elements that stay left come first, and stored whole
+// at both ends of the room.
+template <typename T> struct avx2_partition_ops {
+  using value_type = T;
+  using vec = __m256i;
+  static constexpr size_t lanes = 32 / sizeof(T);
+
+  [[gnu::target("avx2")]] static vec flip_key(vec v) {
+    if constexpr (std::same_as<T, uint32_t>) {
+      return _mm256_xor_si256(v, _mm256_set1_epi32(INT32_MIN));
+    } else if constexpr (std::same_as<T, float>) {
+      const auto sign = _mm256_srai_epi32(v, 31);
+      return _mm256_xor_si256(v, _mm256_srli_epi32(sign, 1));
+    } else {
+      return v;
+    }
+  }
+
+  [[gnu::target("avx2")]] static vec load(const T *data) {
+    return flip_key(_mm256_loadu_si256(reinterpret_cast<const vec *>(data)));
+  }
+
+  [[gnu::target("avx2")]] static vec broadcast(T value) {
+    if constexpr (sizeof(T) == 4) {
+      return flip_key(_mm256_set1_epi32(std::bit_cast<int32_t>(value)));
+    } else {
+      return flip_key(_mm256_set1_epi64x(std::bit_cast<int64_t>(value)));
+    }
+  }
+
+  // Stores the lanes of v that stay left at store_begin and those that go
+  // right before store_end, and moves both past them
+  template <bool IsGreater>
+  [[gnu::target("avx2")]] static void
+  partition_store(vec v, vec pivot, T *&store_begin, T *&store_end) {
+    // Lanes greater than the pivot, or not less than it
+    size_t mask = 0;
+    if constexpr (sizeof(T) == 4) {
+      const auto is_less = _mm256_cmpgt_epi32(pivot, v);
+      const auto is_greater = _mm256_cmpgt_epi32(v, pivot);
+      mask = static_cast<size_t>(_mm256_movemask_ps(
+          _mm256_castsi256_ps(IsGreater ? is_greater : is_less)));
+    } else {
+      const auto is_less = _mm256_cmpgt_epi64(pivot, v);
+      const auto is_greater = _mm256_cmpgt_epi64(v, pivot);
+      mask = static_cast<size_t>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(IsGreater ? is_greater : is_less)));
+    }
+    if constexpr (!IsGreater) {
+      mask ^= (1 << lanes) - 1;
+    }
+
+    const auto permutation = _mm256_loadu_si256(reinterpret_cast<const vec *>(
+        partition_permutations<lanes>[mask].data()));
+    const auto permuted =
+        flip_key(_mm256_permutevar8x32_epi32(v, permutation));
+    _mm256_storeu_si256(reinterpret_cast<vec *>(store_begin), permuted);
+    _mm256_storeu_si256(reinterpret_cast<vec *>(store_end - lanes), permuted);
+    const auto right_count = static_cast<size_t>(std::popcount(mask));
+    store_begin += lanes - right_count;
+    store_end -= right_count;
+  }
+};
+
+// Elements in an AVX-512 register, stored to both ends with compress stores
+template <typename T> struct avx512_partition_ops {
+  using value_type = T;
+  using vec = __m512i;
+  static constexpr size_t lanes = 64 / sizeof(T);
+
+  [[gnu::target("avx512f")]] static vec flip_key(vec v) {
+    if constexpr (std::same_as<T, uint32_t>) {
+      return _mm512_xor_si512(v, _mm512_set1_epi32(INT32_MIN));
+    } else if constexpr (std::same_as<T, float>) {
+      const auto zero = _mm512_setzero_si512();
+      const auto is_negative = _mm512_cmplt_epi32_mask(v, zero);
+      return _mm512_mask_xor_epi32(v, is_negative, v,
+                                   _mm512_set1_epi32(INT32_MAX));
+    } else {
+      return v;
+    }
+  }
+
+  [[gnu::target("avx512f")]] static vec load(const T *data) {
+    return flip_key(_mm512_loadu_si512(data));
+  }
+
+  [[gnu::target("avx512f")]] static vec broadcast(T value) {
+    if constexpr (sizeof(T) == 4) {
+      return flip_key(_mm512_set1_epi32(std::bit_cast<int32_t>(value)));
+    } else {
+      return flip_key(_mm512_set1_epi64(std::bit_cast<int64_t>(value)));
+    }
+  }
+
+  template <bool IsGreater>
+  [[gnu::target("avx512f")]] static void
+  partition_store(vec v, vec pivot, T *&store_begin, T *&store_end) {
+    const auto data = flip_key(v);
+    size_t right_count = 0;
+    if constexpr (sizeof(T) == 4) {
+      const auto is_right = IsGreater ? _mm512_cmpgt_epi32_mask(v, pivot)
+                                      : _mm512_cmpge_epi32_mask(v, pivot);
+      right_count = static_cast<size_t>(std::popcount(is_right));
+      _mm512_mask_compressstoreu_epi32(store_begin, ~is_right, data);
+      _mm512_mask_compressstoreu_epi32(store_end - right_count, is_right,
+                                       data);
+    } else {
+      const auto is_right = IsGreater ? _mm512_cmpgt_epi64_mask(v, pivot)
+                                      : _mm512_cmpge_epi64_mask(v, pivot);
+      right_count = static_cast<size_t>(std::popcount(is_right));
+      _mm512_mask_compressstoreu_epi64(store_begin, ~is_right, data);
+      _mm512_mask_compressstoreu_epi64(store_end - right_count, is_right,
+                                       data);
+    }
+    store_begin += lanes - right_count;
+    store_end -= right_count;
+  }
+};
+
+template <bool IsGreater, typename T>
+[[gnu::target("avx2"), gnu::flatten]] T *
+simd_partition_avx2(T *begin, T *end, T pivot) {
+  return simd_partition_block<avx2_partition_ops<T>, IsGreater>(begin, end,
+                                                                 pivot);
+}
+
+template <bool IsGreater, typename T>
+[[gnu::target("avx512f"), gnu::flatten]] T *
+simd_partition_avx512(T *begin, T *end, T pivot) {
+  return simd_partition_block<avx512_partition_ops<T>, IsGreater>(begin, end,
+                                                                   pivot);
+}
+#endif
+
+// Whether simd_partition runs in SIMD registers for the elements at Iter
+template <std::random_access_iterator Iter> bool has_simd_partition() {
+  if constexpr (std::contiguous_iterator<Iter> &&
+                sorting_network_type<std::iter_value_t<Iter>>) {
+    return cpu_simd_level() >= simd_level::avx2;
+  } else {
+    return false;
+  }
+}
+
+// Partitions [begin, end) into the elements less than pivot and the rest, or
+// with IsGreater into the elements not greater than pivot and the rest, in
+// the order of radix_key. Returns where the rest starts. Needs
+// has_simd_partition<Iter>() and at least sorting_network_max_size elements.
+template <bool IsGreater, std::contiguous_iterator Iter>
+Iter simd_partition(Iter begin, Iter end, std::iter_value_t<Iter> pivot) {
+#if defined(__GNUC__) && defined(__x86_64__)
+  auto *data = std::to_address(begin);
+  auto *data_end = data + (end - begin);
+  if (cpu_simd_level() >= simd_level::avx512) {
+    return begin + (simd_partition_avx512<IsGreater>(data, data_end, pivot) -
+                    data);
+  }
+  return begin +
+         (simd_partition_avx2<IsGreater>(data, data_end, pivot) - data);
+#else
+  return begin;
+#endif
+}
+} // namespace
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace sorting
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include <sorting-algorithm/comparator.hpp>
+#include <sorting-algorithm/insert_sort.hpp>
+#include <sorting-algorithm/natural_merge_sort.hpp>
+#include <sorting-algorithm/quick_sort.hpp>
+#include <sorting-algorithm/radix_sort.hpp>
+
+namespace sorting {
+
+// Sorts sorting::sort dispatches to
+enum class sort_engine {
+  insert_sort,
+  natural_merge_sort,
+  radix_sort,
+  // quick_sort with partition_kernel::simd
+  simd_quick_sort,
+  // quick_sort with partition_kernel::pdq
+  pdq_quick_sort,
+};
+
+inline const char *sort_engine_name(sort_engine engine) {
+  switch (engine) {
+  case sort_engine::insert_sort:
+    return "insert_sort";
+  case sort_engine::natural_merge_sort:
+    return "natural_merge_sort";
+  case sort_engine::radix_sort:
+    return "radix_sort";
+  case sort_engine::simd_quick_sort:
+    return "simd_quick_sort";
+  case sort_engine::pdq_quick_sort:
+    return "pdq_quick_sort";
+  }
+  return "unknown";
+}
+
+// What sorting::sort found in the sample it took of its input. The counts are
+// zero for inputs too small to be sampled, and the key counts also for inputs
+// that are not ordered by radix keys.
+struct sort_profile {
+  size_t size = 0;
+  // Sampled pairs of neighbouring elements, and how many of them were in
+  // ascending and in descending order
+  size_t pair_count = 0;
+  size_t ascent_count = 0;
+  size_t descent_count = 0;
+  // Sampled keys, and how many of them equal another sampled key
+  size_t key_count = 0;
+  size_t duplicate_count = 0;
+  // Number of low bits in which the radix keys of the sample differ
+  size_t key_bit = 0;
+};
+
+// Passed to sort_options::report after a sorting::sort
+struct sort_report {
+  sort_engine engine;
+  sort_profile profile;
+};
+
+// Where sorting::sort switches engines. The defaults come from the benchmark
+// on AVX2 and AVX-512 machines.
+struct sort_thresholds {
+  // Inputs up to this size are insertion sorted without sampling
+  size_t insert_sort_size = 16;
+  // Inputs below this size are quick sorted without sampling. The sample
+  // takes 256 elements, so smaller inputs never are.
+  size_t sample_min_size = 256;
+  // Inputs whose sampled pairs are out of order, one way or the other, at
+  // most this often are merged as natural runs
+  double presorted_ratio = 1.0 / 32;
+  // Inputs whose sampled keys repeat at least this often are quick sorted,
+  // whose partitions drop equal keys early, rather than radix sorted
+  double duplicate_ratio = 0.5;
+  // Inputs with radix keys but no SIMD partition are radix sorted from this
+  // size
+  size_t radix_min_size = 512;
+  // Inputs with a SIMD partition are radix sorted from this size if their
+  // sampled keys differ only in the lowest radix_narrow_key_bit bits, which
+  // leaves radix_sort few passes
+  size_t radix_narrow_min_size = 4096;
+  size_t radix_narrow_key_bit = 24;
+};
+
+// Thresholds of a sorting::sort given no others
+inline constexpr sort_thresholds sort_default_thresholds = sort_thresholds();
+
+// Settings of one sorting::sort
+struct sort_options {
+  sort_thresholds thresholds = sort_default_thresholds;
+  // Called, if set, with the engine the sort chose and the profile it chose
+  // it by
+  std::function<void(const sort_report &)> report;
+};
+
+namespace {
+// Neighbouring pairs are sampled in runs of this many elements, and this many
+// keys are sampled for duplicates and key range
+inline constexpr size_t sort_sample_run_size = 8;
+inline constexpr size_t sort_sample_run_count = 32;
+inline constexpr size_t sort_sample_key_count = 128;
+inline constexpr size_t sort_sample_min_size =
+    sort_sample_run_size * sort_sample_run_count;
+
+template <std::ranges::random_access_range Range, typename Proj>
+using sort_key_t = std::remove_cvref_t<
+    std::invoke_result_t<Proj &, std::ranges::range_reference_t<Range>>>;
+
+// Whether the keys can be radix sorted in the order of less: radix_sort
+// orders integers and floats as operator< does, apart from NaNs, which
+// operator< does not order
+template <std::ranges::random_access_range Range, typename Less, typename Proj>
+constexpr bool is_radix_sortable() {
+  using KeyT = sort_key_t<Range, Proj>;
+  return radix_key_type<KeyT> && is_default_less<Less, KeyT>;
+}
+
+// Counts the ascending and descending pairs in sort_sample_run_count evenly
+// spaced runs of neighbours and between the starts of consecutive runs
+template <std::random_access_iterator Iter, typename Comp>
+void sample_presortedness(Iter begin, size_t size, Comp &comp,
+                          sort_profile &profile) {
+  const size_t step =
+      (size - sort_sample_run_size) / (sort_sample_run_count - 1);
+  for (size_t run = 0; run < sort_sample_run_count; ++run) {
+    const auto first = begin + run * step;
+    for (size_t i = 1; i < sort_sample_run_size; ++i) {
+      profile.ascent_count += comp(first[i - 1], first[i]);
+      profile.descent_count += comp(first[i], first[i - 1]);
+    }
+    if (run > 0) {
+      profile.ascent_count += comp(first[-std::ptrdiff_t(step)], first[0]);
+      profile.descent_count += comp(first[0], first[-std::ptrdiff_t(step)]);
+    }
+  }
+  profile.pair_count = sort_sample_run_count * sort_sample_run_size - 1;
+}
+
+// Sorts radix keys of evenly spaced elements to count the duplicates among
+// them and the bits in which they differ
+template <std::random_access_iterator Iter, typename Proj>
+void sample_keys(Iter begin, size_t size, Proj &proj, sort_profile &profile) {
+  using KeyT = decltype(radix_key(std::invoke(proj, *begin)));
+
+  auto keys = std::array<KeyT, sort_sample_key_count>();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = radix_key(std::invoke(proj, begin[(2 * i + 1) * size /
+                                                 (2 * keys.size())]));
+  }
+  quick_sort(std::span(keys));
+
+  profile.key_count = keys.size();
+  for (size_t i = 1; i < keys.size(); ++i) {
+    profile.duplicate_count += keys[i] == keys[i - 1];
+  }
+  profile.key_bit =
+      static_cast<size_t>(std::bit_width(KeyT(keys.front() ^ keys.back())));
+}
+
+// Picks the engine for range from a sample of it, which profile receives
+template <std::ranges::random_access_range Range, typename Less,
+          typename Proj>
+sort_engine choose_sort_engine(Range &range, Less &less, Proj &proj,
+                               const sort_thresholds &thresholds,
+                               sort_profile &profile) {
+  using IterT = std::ranges::iterator_t<Range>;
+  constexpr bool IsRadixSortable = is_radix_sortable<Range, Less, Proj>();
+
+  const size_t size = std::ranges::size(range);
+  profile.size = size;
+  bool has_simd_quick_sort = false;
+  if constexpr (std::same_as<Proj, std::identity> && IsRadixSortable) {
+    has_simd_quick_sort = has_simd_partition<IterT>();
+  }
+  const auto quick_sort_engine = has_simd_quick_sort
+                                     ? sort_engine::simd_quick_sort
+                                     : sort_engine::pdq_quick_sort;
+
+  if (size <= thresholds.insert_sort_size) {
+    return sort_engine::insert_sort;
+  }
+  if (size < std::max(thresholds.sample_min_size, sort_sample_min_size)) {
+    return quick_sort_engine;
+  }
+
+  auto comp = [&less, &proj](const auto &x, const auto &y) -> bool {
+    return std::invoke(less, std::invoke(proj, x), std::invoke(proj, y));
+  };
+  sample_presortedness(std::ranges::begin(range), size, comp, profile);
+  const auto unordered_count =
+      std::min(profile.ascent_count, profile.descent_count);
+  if (double(unordered_count) <=
+      thresholds.presorted_ratio * double(profile.pair_count)) {
+    return sort_engine::natural_merge_sort;
+  }
+
+  // Keys are only sampled where they can make radix_sort win, since on a
+  // few thousand elements that costs about as much as sorting them
+  if constexpr (IsRadixSortable) {
+    const size_t radix_min_size = has_simd_quick_sort
+                                      ? thresholds.radix_narrow_min_size
+                                      : thresholds.radix_min_size;
+    if (size < radix_min_size) {
+      return quick_sort_engine;
+    }
+
+    sample_keys(std::ranges::begin(range), size, proj, profile);
+    if (double(profile.duplicate_count) >=
+            thresholds.duplicate_ratio * double(profile.key_count) ||
+        (has_simd_quick_sort &&
+         profile.key_bit > thresholds.radix_narrow_key_bit)) {
+      return quick_sort_engine;
+    }
+    return sort_engine::radix_sort;
+  } else {
+    return sort_engine::pdq_quick_sort;
+  }
+}
+} // namespace
+
+// Not stable. Samples the input for how presorted it is and, for integer and
+// float keys in their default order, how often keys repeat and how wide
+// their range is, and sorts it with whichever of the engines above suits that
+// best according to options.thresholds. Sampling reads a few hundred
+// elements and is skipped for small inputs.
+template <std::ranges::random_access_range Range, typename Comp = std::less<>,
+          typename Proj = std::identity>
+  requires std::sortable<std::ranges::iterator_t<Range>, Comp, Proj>
+void sort(Range &&range, Comp comp = {}, Proj proj = {},
+          const sort_options &options = {}) {
+  auto profile = sort_profile();
+  const auto engine =
+      choose_sort_engine(range, comp, proj, options.thresholds, profile);
+
+  switch (engine) {
+  case sort_engine::insert_sort:
+    insert_sort(range, std::move(comp), std::move(proj));
+    break;
+  case sort_engine::natural_merge_sort:
+    natural_merge_sort(range, std::move(comp), std::move(proj));
+    break;
+  case sort_engine::radix_sort:
+    if constexpr (is_radix_sortable<Range, Comp, Proj>()) {
+      radix_sort(range, std::move(proj));
+    }
+    break;
+  case sort_engine::simd_quick_sort:
+    quick_sort<partition_kernel::simd>(range, std::move(comp),
+                                       std::move(proj));
+    break;
+  case sort_engine::pdq_quick_sort:
+    quick_sort<partition_kernel::pdq>(range, std::move(comp), std::move(proj));
+    break;
+  }
+
+  if (options.report) {
+    options.report({engine, profile});
+  }
+}
+
+} // namespace sorting
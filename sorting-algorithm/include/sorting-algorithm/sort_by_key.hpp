@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sorting-algorithm/comparator.hpp>
+#include <sorting-algorithm/merge_sort.hpp>
+#include <sorting-algorithm/radix_sort.hpp>
+
+namespace sorting {
+
+namespace {
+// A key of the key column with its position, which radix_sort moves as one
+template <typename KeyT, typename Index> struct indexed_key {
+  KeyT key;
+  Index index;
+};
+
+template <std::ranges::random_access_range Range, typename Proj>
+using projected_key_t = std::remove_cvref_t<
+    std::invoke_result_t<Proj &, std::ranges::range_reference_t<Range>>>;
+
+// Whether argsort orders the keys by radix_sort: integers in their own order
+template <std::ranges::random_access_range Range, typename Comp, typename Proj>
+constexpr bool is_radix_argsort() {
+  using KeyT = projected_key_t<Range, Proj>;
+  return std::is_integral_v<KeyT> && !std::is_same_v<KeyT, bool> &&
+         is_default_less<Comp, KeyT>;
+}
+
+// Below this size argsort_impl merge sorts instead, since the count tables
+// cost more than they save
+inline constexpr size_t radix_argsort_min_size = 256;
+
+// Writes the stable sorting permutation of keys to indices. With radix_sort
+// the projected keys are sorted along with their positions; if SortKeys and
+// they are the elements themselves, they are written back to keys in order
+// and true is returned.
+template <bool SortKeys, std::ranges::random_access_range Range,
+          typename Index, typename Comp, typename Proj>
+bool argsort_impl(Range &keys, std::span<Index> indices, Comp &comp,
+                  Proj &proj) {
+  const size_t size = std::ranges::size(keys);
+  assert(indices.size() == size);
+  assert(size == 0 || size - 1 <= std::numeric_limits<Index>::max());
+  auto begin = std::ranges::begin(keys);
+
+  if constexpr (is_radix_argsort<Range, Comp, Proj>()) {
+    if (size >= radix_argsort_min_size) {
+      using KeyT = projected_key_t<Range, Proj>;
+      auto items = std::vector<indexed_key<KeyT, Index>>(size);
+      for (size_t i = 0; i < size; ++i) {
+        items[i] = {std::invoke(proj, begin[i]), static_cast<Index>(i)};
+      }
+      radix_sort(items, &indexed_key<KeyT, Index>::key);
+
+      for (size_t i = 0; i < size; ++i) {
+        indices[i] = items[i].index;
+      }
+      if constexpr (SortKeys && std::same_as<Proj, std::identity>) {
+        for (size_t i = 0; i < size; ++i) {
+          begin[i] = items[i].key;
+        }
+        return true;
+      }
+      return false;
+    }
+  }
+
+  std::iota(indices.begin(), indices.end(), Index(0));
+  merge_sort(indices, comp, [&](Index i) -> decltype(auto) {
+    return std::invoke(proj, begin[i]);
+  });
+  return false;
+}
+} // namespace
+
+// Reorders range so that its i-th element is the indices[i]-th one before, as
+// after sorting by a permutation from argsort. Allocates one buffer of the
+// size of range.
+template <std::ranges::random_access_range Range,
+          std::ranges::input_range Indices>
+  requires std::integral<std::ranges::range_value_t<Indices>>
+void apply_permutation(Range &&range, const Indices &indices) {
+  assert(std::ranges::size(range) == std::ranges::size(indices));
+  auto begin = std::ranges::begin(range);
+  auto permuted = std::vector<std::ranges::range_value_t<Range>>();
+  permuted.reserve(std::ranges::size(range));
+  for (const auto i : indices) {
+    permuted.push_back(std::move(begin[i]));
+  }
+  std::ranges::move(permuted, begin);
+}
+
+// Returns the permutation that stably sorts keys by comp on proj(x): the
+// index of the least key, then of the next one, and so on. Integer keys in
+// their default order are radix sorted along with their indices, other keys
+// merge sorted by index. Index must be able to hold every index of keys.
+template <std::unsigned_integral Index = std::uint32_t,
+          std::ranges::random_access_range Range, typename Comp = std::less<>,
+          typename Proj = std::identity>
+  requires std::indirect_strict_weak_order<
+      Comp, std::projected<std::ranges::iterator_t<Range>, Proj>>
+std::vector<Index> argsort(Range &&keys, Comp comp = {}, Proj proj = {}) {
+  auto indices = std::vector<Index>(std::ranges::size(keys));
+  argsort_impl<false>(keys, std::span(indices), comp, proj);
+  return indices;
+}
+
+// Stably sorts keys and moves the elements of every values range, each as
+// long as keys, in lockstep with them: the columns are reordered one at a time
+// by the permutation that sorts keys, without gathering rows into structs.
+// Keys are ordered as in argsort.
+template <std::ranges::random_access_range Keys,
+          std::ranges::random_access_range... Values>
+  requires std::sortable<std::ranges::iterator_t<Keys>>
+void sort_by_key(Keys &&keys, Values &&...values) {
+  const size_t size = std::ranges::size(keys);
+  assert(((std::ranges::size(values) == size) && ...));
+
+  auto sort = [&]<typename Index>(Index) {
+    auto comp = std::less<>();
+    auto proj = std::identity();
+    auto indices = std::vector<Index>(size);
+    const bool is_keys_sorted =
+        argsort_impl<true>(keys, std::span(indices), comp, proj);
+
+    const auto permutation = std::span<const Index>(indices);
+    if (!is_keys_sorted) {
+      apply_permutation(keys, permutation);
+    }
+    (apply_permutation(values, permutation), ...);
+  };
+  if (size <= std::numeric_limits<std::uint32_t>::max()) {
+    sort(std::uint32_t());
+  } else {
+    sort(std::uint64_t());
+  }
+}
+
+} // namespace sorting
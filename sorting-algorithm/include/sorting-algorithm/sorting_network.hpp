@@ -0,0 +1,424 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+
+#include <sorting-algorithm/insert_sort.hpp>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace sorting {
+
+// Element types that sorting_network_sort sorts in SIMD registers
+template <typename T>
+concept sorting_network_type =
+    std::same_as<T, int32_t> || std::same_as<T, uint32_t> ||
+    std::same_as<T, int64_t> || std::same_as<T, float>;
+
+// Largest range that sorting_network_sort takes
+inline constexpr size_t sorting_network_max_size = 64;
+
+// The network templates pass vectors by value but are only ever inlined into
+// the entry points compiled for the ISA, so their ABI never shows. They are
+// always_inline because flatten alone inlines nothing without optimization,
+// which left them as functions of the base ISA passing AVX vectors to the
+// AVX2 ones in a different ABI.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace {
+// Each level includes the ones before it
+enum class simd_level { none, sse41, avx2, avx512 };
+
+inline simd_level cpu_simd_level() {
+  static const simd_level level = [] {
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return simd_level::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+      return simd_level::sse41;
+    }
+#endif
+    return simd_level::none;
+  }();
+  return level;
+}
+
+// Bit lane of the blend mask of a bitonic stage comparing lane i with lane
+// i ^ J is set where the lane keeps the maximum: in the upper lane of each
+// pair, unless the pair lies in a descending block of K lanes. Blocks of at
+// least Lanes lanes are flipped a whole register at a time by the caller.
+template <size_t Lanes, size_t K, size_t J> constexpr unsigned max_lane_mask() {
+  unsigned mask = 0;
+  for (size_t lane = 0; lane < Lanes; ++lane) {
+    const bool is_upper = (lane & J) != 0;
+    const bool is_descending = K < Lanes && (lane & K) != 0;
+    mask |= static_cast<unsigned>(is_upper != is_descending) << lane;
+  }
+  return mask;
+}
+
+// Repeats every bit of mask Width times, to blend wide lanes with a narrower
+// blend instruction
+template <size_t Width> constexpr unsigned widen_lane_mask(unsigned mask) {
+  unsigned wide_mask = 0;
+  for (size_t bit = 0; bit < 32 / Width; ++bit) {
+    if ((mask >> bit) & 1) {
+      wide_mask |= ((1u << Width) - 1) << (bit * Width);
+    }
+  }
+  return wide_mask;
+}
+
+// One stage of a bitonic sorting network over the Lanes * RegCount elements
+// held in regs, in which element i is compare-exchanged with element i ^ J
+// and blocks of K elements alternate between ascending and descending order
+template <typename Ops, size_t K, size_t J, size_t RegCount>
+[[gnu::always_inline]] inline void
+bitonic_stage(typename Ops::vec (&regs)[RegCount]) {
+  constexpr size_t Lanes = Ops::lanes;
+  if constexpr (J >= Lanes) {
+    // Partners sit in different registers: a vertical min/max
+    constexpr size_t RegStride = J / Lanes;
+    for (size_t r = 0; r < RegCount; ++r) {
+      if ((r & RegStride) != 0) {
+        continue;
+      }
+      if (((r * Lanes) & K) != 0) {
+        Ops::min_max(regs[r + RegStride], regs[r]);
+      } else {
+        Ops::min_max(regs[r], regs[r + RegStride]);
+      }
+    }
+  } else {
+    // Partners sit in the same register: a lane shuffle, min/max and blend
+    constexpr unsigned Mask = max_lane_mask<Lanes, K, J>();
+    for (size_t r = 0; r < RegCount; ++r) {
+      auto lo = regs[r];
+      auto hi = Ops::template swap_lanes<J>(regs[r]);
+      Ops::min_max(lo, hi);
+      const bool is_descending = K >= Lanes && ((r * Lanes) & K) != 0;
+      regs[r] = is_descending ? Ops::template blend<Mask>(hi, lo)
+                              : Ops::template blend<Mask>(lo, hi);
+    }
+  }
+}
+
+template <typename Ops, size_t K, size_t J, size_t RegCount>
+[[gnu::always_inline]] inline void
+bitonic_merge_stages(typename Ops::vec (&regs)[RegCount]) {
+  bitonic_stage<Ops, K, J>(regs);
+  if constexpr (J > 1) {
+    bitonic_merge_stages<Ops, K, J / 2>(regs);
+  }
+}
+
+template <typename Ops, size_t K, size_t RegCount>
+[[gnu::always_inline]] inline void
+bitonic_sort_stages(typename Ops::vec (&regs)[RegCount]) {
+  bitonic_merge_stages<Ops, K, K / 2>(regs);
+  if constexpr (K < Ops::lanes * RegCount) {
+    bitonic_sort_stages<Ops, K * 2>(regs);
+  }
+}
+
+// Sorts size <= Lanes * RegCount elements, padded with the greatest key
+template <typename Ops, size_t RegCount>
+[[gnu::always_inline]] inline void
+sorting_network_block(typename Ops::value_type *data, size_t size) {
+  using T = typename Ops::value_type;
+  constexpr size_t BlockSize = Ops::lanes * RegCount;
+
+  alignas(32) T block[BlockSize];
+  std::copy(data, data + size, block);
+  std::fill(block + size, block + BlockSize, Ops::padding());
+
+  typename Ops::vec regs[RegCount];
+  for (size_t r = 0; r < RegCount; ++r) {
+    regs[r] = Ops::load(block + r * Ops::lanes);
+  }
+  bitonic_sort_stages<Ops, 2>(regs);
+  for (size_t r = 0; r < RegCount; ++r) {
+    Ops::store(block + r * Ops::lanes, regs[r]);
+  }
+
+  std::copy(block, block + size, data);
+}
+
+// Sorts size <= sorting_network_max_size elements in the smallest block of a
+// power of two registers that holds them
+template <typename Ops>
+[[gnu::always_inline]] inline void
+sorting_network_blocks(typename Ops::value_type *data, size_t size) {
+  constexpr size_t Lanes = Ops::lanes;
+  if (size <= Lanes) {
+    sorting_network_block<Ops, 1>(data, size);
+  } else if (size <= 2 * Lanes) {
+    sorting_network_block<Ops, 2>(data, size);
+  } else if (size <= 4 * Lanes) {
+    sorting_network_block<Ops, 4>(data, size);
+  } else if constexpr (8 * Lanes >= sorting_network_max_size) {
+    sorting_network_block<Ops, 8>(data, size);
+  } else if (size <= 8 * Lanes) {
+    sorting_network_block<Ops, 8>(data, size);
+  } else {
+    sorting_network_block<Ops, 16>(data, size);
+  }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// 32-bit keys in the 8 lanes of an AVX2 register. Floats are sorted as signed
+// 32-bit keys: flipping all but the sign bit of negative floats makes their
+// bit patterns order like the values, and the flip is its own inverse.
+template <typename T> struct avx2_ops32 {
+  using value_type = T;
+  using vec = __m256i;
+  static constexpr size_t lanes = 8;
+
+  static T padding() {
+    if constexpr (std::same_as<T, float>) {
+      return std::bit_cast<float>(std::numeric_limits<int32_t>::max());
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+
+  [[gnu::target("avx2")]] static vec flip_float(vec v) {
+    if constexpr (std::same_as<T, float>) {
+      const auto sign = _mm256_srai_epi32(v, 31);
+      return _mm256_xor_si256(v, _mm256_srli_epi32(sign, 1));
+    } else {
+      return v;
+    }
+  }
+
+  [[gnu::target("avx2")]] static vec load(const T *data) {
+    return flip_float(_mm256_load_si256(reinterpret_cast<const vec *>(data)));
+  }
+
+  [[gnu::target("avx2")]] static void store(T *data, vec v) {
+    _mm256_store_si256(reinterpret_cast<vec *>(data), flip_float(v));
+  }
+
+  [[gnu::target("avx2")]] static void min_max(vec &a, vec &b) {
+    if constexpr (std::same_as<T, uint32_t>) {
+      const auto lo = _mm256_min_epu32(a, b);
+      b = _mm256_max_epu32(a, b);
+      a = lo;
+    } else {
+      const auto lo = _mm256_min_epi32(a, b);
+      b = _mm256_max_epi32(a, b);
+      a = lo;
+    }
+  }
+
+  template <size_t J> [[gnu::target("avx2")]] static vec swap_lanes(vec v) {
+    if constexpr (J == 1) {
+      return _mm256_shuffle_epi32(v, 0b10110001);
+    } else if constexpr (J == 2) {
+      return _mm256_shuffle_epi32(v, 0b01001110);
+    } else {
+      return _mm256_permute2x128_si256(v, v, 1);
+    }
+  }
+
+  template <unsigned Mask>
+  [[gnu::target("avx2")]] static vec blend(vec a, vec b) {
+    return _mm256_blend_epi32(a, b, Mask);
+  }
+};
+
+// 64-bit signed keys in the 4 lanes of an AVX2 register, which has no 64-bit
+// min or max, so they are a compare and two blends
+struct avx2_ops64 {
+  using value_type = int64_t;
+  using vec = __m256i;
+  static constexpr size_t lanes = 4;
+
+  static int64_t padding() { return std::numeric_limits<int64_t>::max(); }
+
+  [[gnu::target("avx2")]] static vec load(const int64_t *data) {
+    return _mm256_load_si256(reinterpret_cast<const vec *>(data));
+  }
+
+  [[gnu::target("avx2")]] static void store(int64_t *data, vec v) {
+    _mm256_store_si256(reinterpret_cast<vec *>(data), v);
+  }
+
+  [[gnu::target("avx2")]] static void min_max(vec &a, vec &b) {
+    const auto is_greater = _mm256_cmpgt_epi64(a, b);
+    const auto lo = _mm256_blendv_epi8(a, b, is_greater);
+    b = _mm256_blendv_epi8(b, a, is_greater);
+    a = lo;
+  }
+
+  template <size_t J> [[gnu::target("avx2")]] static vec swap_lanes(vec v) {
+    if constexpr (J == 1) {
+      return _mm256_shuffle_epi32(v, 0b01001110);
+    } else {
+      return _mm256_permute4x64_epi64(v, 0b01001110);
+    }
+  }
+
+  template <unsigned Mask>
+  [[gnu::target("avx2")]] static vec blend(vec a, vec b) {
+    // A constant, since without optimization GCC does not fold the call
+    // into the immediate
+    constexpr int WideMask = static_cast<int>(widen_lane_mask<2>(Mask));
+    return _mm256_blend_epi32(a, b, WideMask);
+  }
+};
+
+// 32-bit keys in the 4 lanes of an SSE register
+template <typename T> struct sse41_ops32 {
+  using value_type = T;
+  using vec = __m128i;
+  static constexpr size_t lanes = 4;
+
+  static T padding() { return avx2_ops32<T>::padding(); }
+
+  [[gnu::target("sse4.1")]] static vec flip_float(vec v) {
+    if constexpr (std::same_as<T, float>) {
+      const auto sign = _mm_srai_epi32(v, 31);
+      return _mm_xor_si128(v, _mm_srli_epi32(sign, 1));
+    } else {
+      return v;
+    }
+  }
+
+  [[gnu::target("sse4.1")]] static vec load(const T *data) {
+    return flip_float(_mm_load_si128(reinterpret_cast<const vec *>(data)));
+  }
+
+  [[gnu::target("sse4.1")]] static void store(T *data, vec v) {
+    _mm_store_si128(reinterpret_cast<vec *>(data), flip_float(v));
+  }
+
+  [[gnu::target("sse4.1")]] static void min_max(vec &a, vec &b) {
+    if constexpr (std::same_as<T, uint32_t>) {
+      const auto lo = _mm_min_epu32(a, b);
+      b = _mm_max_epu32(a, b);
+      a = lo;
+    } else {
+      const auto lo = _mm_min_epi32(a, b);
+      b = _mm_max_epi32(a, b);
+      a = lo;
+    }
+  }
+
+  template <size_t J> [[gnu::target("sse4.1")]] static vec swap_lanes(vec v) {
+    if constexpr (J == 1) {
+      return _mm_shuffle_epi32(v, 0b10110001);
+    } else {
+      return _mm_shuffle_epi32(v, 0b01001110);
+    }
+  }
+
+  template <unsigned Mask>
+  [[gnu::target("sse4.1")]] static vec blend(vec a, vec b) {
+    constexpr int WideMask = static_cast<int>(widen_lane_mask<2>(Mask));
+    return _mm_blend_epi16(a, b, WideMask);
+  }
+};
+
+// flatten inlines the generic network, and with it the intrinsics, into
+// these entry points, which are the only code compiled for the wider ISA
+template <typename T>
+[[gnu::target("avx2"), gnu::flatten]] void
+sorting_network_sort_avx2(T *data, size_t size) {
+  if constexpr (std::same_as<T, int64_t>) {
+    sorting_network_blocks<avx2_ops64>(data, size);
+  } else {
+    sorting_network_blocks<avx2_ops32<T>>(data, size);
+  }
+}
+
+template <typename T>
+[[gnu::target("sse4.1"), gnu::flatten]] void
+sorting_network_sort_sse41(T *data, size_t size) {
+  sorting_network_blocks<sse41_ops32<T>>(data, size);
+}
+
+#endif
+
+// Whether insertion sort or a sorting network sorts small ranges of the
+// elements at Iter
+template <std::random_access_iterator Iter>
+bool has_simd_small_sort() {
+  using ValueT = std::iter_value_t<Iter>;
+  if constexpr (std::contiguous_iterator<Iter> &&
+                sorting_network_type<ValueT>) {
+    const auto level = cpu_simd_level();
+    return level >= simd_level::avx2 ||
+           (level == simd_level::sse41 && sizeof(ValueT) == 4);
+  } else {
+    return false;
+  }
+}
+
+// Leaf sort of the recursive sorts: a sorting network when the elements and
+// the CPU allow it, or else insertion sort. Not stable, but the network only
+// takes plain integers and floats, whose equal values only -0.0 and 0.0 tell
+// apart.
+template <std::random_access_iterator Iter>
+void small_sort(Iter begin, Iter end) {
+  using ValueT = std::iter_value_t<Iter>;
+  if constexpr (std::contiguous_iterator<Iter> &&
+                sorting_network_type<ValueT>) {
+#if defined(__GNUC__) && defined(__x86_64__)
+    const auto size = static_cast<size_t>(std::distance(begin, end));
+    if (size <= sorting_network_max_size) {
+      const auto level = cpu_simd_level();
+      if (level >= simd_level::avx2) {
+        sorting_network_sort_avx2(std::to_address(begin), size);
+        return;
+      }
+      if (level == simd_level::sse41 && sizeof(ValueT) == 4) {
+        sorting_network_sort_sse41(std::to_address(begin), size);
+        return;
+      }
+    }
+#endif
+  }
+  auto range = std::ranges::subrange(begin, end);
+  insert_sort(range);
+}
+} // namespace
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// Whether sorting_network_sort runs in SIMD registers for T on this CPU:
+// AVX2 for every sorting_network_type, SSE4.1 for the 32-bit ones
+template <sorting_network_type T> bool has_simd_sorting_network() {
+  return has_simd_small_sort<T *>();
+}
+
+// Sorts at most sorting_network_max_size elements with a bitonic sorting
+// network in SIMD registers, picked for the CPU at run time, and falls back to
+// insert_sort where there is none or the range is longer
+template <std::ranges::contiguous_range Range>
+  requires sorting_network_type<std::ranges::range_value_t<Range>>
+void sorting_network_sort(Range &range) {
+  small_sort(std::ranges::begin(range), std::ranges::end(range));
+}
+
+} // namespace sorting
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sorting {
+
+// Work-stealing thread pool. A task submitted from a worker goes to the back
+// of that worker's queue; workers take tasks from the back of their own queue
+// and steal from the front of the others' when it runs dry. Tasks submitted
+// from other threads are spread over the queues round-robin.
+class thread_pool {
+public:
+  using task = std::function<void()>;
+
+  explicit thread_pool(size_t num_threads = default_size())
+      : queues_(std::max<size_t>(num_threads, 1)) {
+    for (auto &queue : queues_) {
+      queue = std::make_unique<task_queue>();
+    }
+    workers_.reserve(queues_.size());
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      workers_.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard lock(sleep_mutex_);
+      is_stopped_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  size_t size() const { return workers_.size(); }
+
+  void submit(task t) {
+    const auto &self = current_worker();
+    const size_t index = (self.pool == this)
+                             ? self.index
+                             : next_queue_.fetch_add(1) % queues_.size();
+    {
+      // Counted before the task can be taken, which would count it off
+      std::lock_guard lock(sleep_mutex_);
+      ++queued_count_;
+    }
+    {
+      std::lock_guard lock(queues_[index]->mutex);
+      queues_[index]->tasks.push_back(std::move(t));
+    }
+    sleep_cv_.notify_one();
+  }
+
+  // Runs one queued task on the calling thread. Returns false if there was
+  // none, so that a thread waiting on tasks can help instead of blocking.
+  bool run_pending_task() {
+    const auto &self = current_worker();
+    auto t = task();
+    if (!take(self.pool == this ? self.index : 0, t)) {
+      return false;
+    }
+    t();
+    return true;
+  }
+
+  // Leaves one hardware thread to the caller, which helps while it waits
+  static size_t default_size() {
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 1;
+  }
+
+private:
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  struct worker_id {
+    const thread_pool *pool = nullptr;
+    size_t index = 0;
+  };
+
+  static worker_id &current_worker() {
+    static thread_local worker_id id;
+    return id;
+  }
+
+  // Pops from the back of queue index, or else steals from the front of the
+  // next non-empty queue
+  bool take(size_t index, task &t) {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      auto &queue = *queues_[(index + i) % queues_.size()];
+      std::lock_guard lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        t = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        t = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      queued_count_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  void work(size_t index) {
+    current_worker() = {this, index};
+    while (true) {
+      auto t = task();
+      if (take(index, t)) {
+        t();
+        continue;
+      }
+
+      std::unique_lock lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [this] { return is_stopped_ || queued_count_ > 0; });
+      if (is_stopped_ && queued_count_ == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<task_queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> next_queue_ = 0;
+  std::atomic<size_t> queued_count_ = 0;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool is_stopped_ = false;
+};
+
+// Pool shared by the parallel algorithms unless they are given one
+inline thread_pool &default_thread_pool() {
+  static thread_pool pool;
+  return pool;
+}
+
+// Tasks of one fork-join computation. Tasks may spawn further tasks into the
+// same group; wait() runs queued tasks on the calling thread until all of
+// them have finished, then rethrows the first exception one of them threw.
+class task_group {
+public:
+  explicit task_group(thread_pool &pool) : pool_(pool) {}
+
+  task_group(const task_group &) = delete;
+  task_group &operator=(const task_group &) = delete;
+
+  // Waits without rethrowing, as a destructor must not throw
+  ~task_group() { finish(); }
+
+  template <typename Fn> void run(Fn fn) {
+    pending_count_.fetch_add(1);
+    pool_.submit([this, fn = std::move(fn)]() mutable {
+      try {
+        fn();
+      } catch (...) {
+        std::lock_guard lock(exception_mutex_);
+        if (!exception_) {
+          exception_ = std::current_exception();
+        }
+      }
+      pending_count_.fetch_sub(1);
+    });
+  }
+
+  void wait() {
+    finish();
+    if (exception_) {
+      std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+  }
+
+private:
+  void finish() {
+    while (pending_count_.load() != 0) {
+      if (!pool_.run_pending_task()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  thread_pool &pool_;
+  std::atomic<size_t> pending_count_ = 0;
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+} // namespace sorting
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/external_sort.hpp>
+#include <sorting-algorithm/radix_sort.hpp>
+
+// Counts the operator new calls of this thread, and the bytes they hold, while
+// it is alive. This binary replaces the global operator new and operator
+// delete to do so, which is why it is not part of test_sorting-algorithm.
+struct AllocationScope {
+  size_t count = 0;
+  std::ptrdiff_t live_bytes = 0;
+  std::ptrdiff_t peak_bytes = 0;
+
+  AllocationScope() { current() = this; }
+  ~AllocationScope() { current() = nullptr; }
+
+  AllocationScope(const AllocationScope &) = delete;
+  AllocationScope &operator=(const AllocationScope &) = delete;
+
+  static AllocationScope *&current() {
+    static thread_local AllocationScope *scope = nullptr;
+    return scope;
+  }
+};
+
+// Every block starts with a header of its alignment, whose last word holds
+// the size asked for, so that delete can count it off without being told
+size_t headerSize(std::align_val_t alignment) {
+  return std::max(static_cast<size_t>(alignment),
+                  size_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__));
+}
+
+void *allocate(size_t size, std::align_val_t alignment) noexcept {
+  const size_t header = headerSize(alignment);
+  const size_t total = (header + size + header - 1) / header * header;
+  auto *base = static_cast<std::byte *>(std::aligned_alloc(header, total));
+  if (base == nullptr) {
+    return nullptr;
+  }
+  auto *ptr = base + header;
+  std::memcpy(ptr - sizeof(size), &size, sizeof(size));
+  if (auto *scope = AllocationScope::current()) {
+    scope->count += 1;
+    scope->live_bytes += static_cast<std::ptrdiff_t>(size);
+    scope->peak_bytes = std::max(scope->peak_bytes, scope->live_bytes);
+  }
+  return ptr;
+}
+
+void *allocateOrThrow(size_t size, std::align_val_t alignment) {
+  if (void *ptr = allocate(size, alignment)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void deallocate(void *ptr, std::align_val_t alignment) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto *bytes = static_cast<std::byte *>(ptr);
+  size_t size = 0;
+  std::memcpy(&size, bytes - sizeof(size), sizeof(size));
+  if (auto *scope = AllocationScope::current()) {
+    scope->live_bytes -= static_cast<std::ptrdiff_t>(size);
+  }
+  std::free(bytes - headerSize(alignment));
+}
+
+constexpr auto default_alignment =
+    std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+void *operator new(size_t size) {
+  return allocateOrThrow(size, default_alignment);
+}
+void *operator new[](size_t size) {
+  return allocateOrThrow(size, default_alignment);
+}
+void *operator new(size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, alignment);
+}
+void *operator new[](size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, alignment);
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size, default_alignment);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size, default_alignment);
+}
+void *operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  return allocate(size, alignment);
+}
+void *operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  return allocate(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete[](void *ptr) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete(void *ptr, size_t) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete[](void *ptr, size_t) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete(void *ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete(void *ptr, size_t, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void *ptr, size_t, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  deallocate(ptr, default_alignment);
+}
+void operator delete(void *ptr, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  deallocate(ptr, alignment);
+}
+void operator delete[](void *ptr, std::align_val_t alignment,
+                       const std::nothrow_t &) noexcept {
+  deallocate(ptr, alignment);
+}
+
+// With a scratch buffer and DigitBit below 16 nothing is allocated, except
+// for the one table of write-combining buffers of a sort whose passes use
+// them
+template <typename Type> bool testRadixSortNoAllocation(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  const auto input = generateRandomVector<T>(size);
+  auto expect = input;
+  std::sort(expect.begin(), expect.end());
+  auto scratch = std::vector<T>(size);
+
+  auto direct8 = input;
+  auto direct11 = input;
+  auto combined8 = input;
+  auto combined11 = input;
+  {
+    auto scope = AllocationScope();
+    sorting::radix_sort<8, SIZE_MAX>(direct8, std::span(scratch));
+    sorting::radix_sort<11, SIZE_MAX>(direct11, std::span(scratch));
+    ASSERT_EQ(size_t(0), scope.count);
+  }
+  {
+    auto scope = AllocationScope();
+    sorting::radix_sort<8, 0>(combined8, std::span(scratch));
+    ASSERT_EQ(true, scope.count <= 1);
+  }
+  {
+    auto scope = AllocationScope();
+    sorting::radix_sort<11, 0>(combined11, std::span(scratch));
+    ASSERT_EQ(true, scope.count <= 1);
+  }
+  ASSERT_EQ(expect, direct8);
+  ASSERT_EQ(expect, direct11);
+  ASSERT_EQ(expect, combined8);
+  ASSERT_EQ(expect, combined11);
+  return is_ok;
+}
+TestSortLarge(RadixSortNoAllocation, uint8_t);
+TestSortLarge(RadixSortNoAllocation, int32_t);
+TestSortLarge(RadixSortNoAllocation, uint64_t);
+TestSortLarge(RadixSortNoAllocation, double);
+
+// The run buffer and its scratch take the whole budget, so they have to be
+// freed before the merge buffers, which take it again, are allocated
+bool testExternalSortPeakMemory() {
+  bool is_ok = true;
+  using T = uint64_t;
+  const auto directory =
+      std::filesystem::temp_directory_path() /
+      ("test_allocation-" + std::to_string(std::random_device()()));
+  std::filesystem::create_directory(directory);
+  const auto input = directory / "input";
+  const auto output = directory / "output";
+
+  // Eight runs, merged in one pass
+  auto options = sorting::external_sort_options();
+  options.memory_budget = size_t(1) << 20;
+  options.merge_buffer_size = size_t(1) << 16;
+  options.temp_dir = directory;
+  auto data = generateRandomVector<T>(4 * options.memory_budget / sizeof(T));
+  auto file = std::fopen(input.string().c_str(), "wb");
+  ASSERT_EQ(data.size(),
+            std::fwrite(data.data(), sizeof(T), data.size(), file));
+  ASSERT_EQ(0, std::fclose(file));
+
+  auto peak_bytes = std::ptrdiff_t(0);
+  {
+    auto scope = AllocationScope();
+    sorting::external_sort<T>(input, output, options);
+    peak_bytes = scope.peak_bytes;
+  }
+  std::ranges::sort(data);
+  auto actual = std::vector<T>(data.size());
+  file = std::fopen(output.string().c_str(), "rb");
+  ASSERT_EQ(actual.size(),
+            std::fread(actual.data(), sizeof(T), actual.size(), file));
+  std::fclose(file);
+  std::filesystem::remove_all(directory);
+
+  ASSERT_EQ(data, actual);
+  const auto budget = static_cast<std::ptrdiff_t>(options.memory_budget);
+  ASSERT_EQ(true, peak_bytes <= budget + budget / 4);
+  return is_ok;
+}
+TestRegistrar registrar_testExternalSortPeakMemory(
+    "testExternalSortPeakMemory", testExternalSortPeakMemory);
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include <test_utility.hpp>
@@ -10,10 +14,22 @@ template <typename T> std::vector<T> generateRandomVector(size_t size) {
   std::vector<T> vec(size);
   std::random_device rd;
   std::mt19937 gen(rd());
-  std::uniform_int_distribution<T> distrib(std::numeric_limits<T>::min(),
-                                           std::numeric_limits<T>::max());
-  for (T &val : vec) {
-    val = distrib(gen);
+  if constexpr (std::is_integral_v<T>) {
+    std::uniform_int_distribution<T> distrib(std::numeric_limits<T>::min(),
+                                             std::numeric_limits<T>::max());
+    for (T &val : vec) {
+      val = distrib(gen);
+    }
+  } else {
+    // Random bit patterns cover zeros, subnormals and infinities; NaNs are
+    // redrawn since they do not compare equal
+    using BitsT = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    std::uniform_int_distribution<BitsT> distrib;
+    for (T &val : vec) {
+      do {
+        val = std::bit_cast<T>(distrib(gen));
+      } while (std::isnan(val));
+    }
   }
   return vec;
 }
@@ -24,3 +40,11 @@ const Sizes sizeParameter = {1 << 0, 1 << 2, 1 << 4, 1 << 6, 1 << 8, 1 << 10};
 #define TestSort(TargetSort, Type)                                             \
   TestRegistrar registrar_test##TargetSort##Type##Size(                        \
       "test" #TargetSort "/" #Type, test##TargetSort<Type>, sizeParameter);
+
+// Above sizeParameter, so that no test is registered twice under one name
+const Sizes largeSizeParameter = {1 << 12, 1 << 16, 1 << 18};
+
+#define TestSortLarge(TargetSort, Type)                                        \
+  TestRegistrar registrar_test##TargetSort##Type##LargeSize(                   \
+      "test" #TargetSort "/" #Type, test##TargetSort<Type>,                    \
+      largeSizeParameter);
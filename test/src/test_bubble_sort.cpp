@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
+#include <span>
 
 #include <test_sort_utility.hpp>
 
@@ -29,3 +31,24 @@ TestSort(BubbleSort, int64_t);
 TestSort(BubbleSort, uint8_t);
 TestSort(BubbleSort, uint32_t);
 TestSort(BubbleSort, uint64_t);
+
+template <typename Type> bool testBubbleSortDescending(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect, std::greater<>());
+
+    auto actual = std::move(input);
+    sorting::bubble_sort(std::span(actual), std::greater<>());
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(BubbleSortDescending, int8_t);
+TestSort(BubbleSortDescending, uint64_t);
+TestSort(BubbleSortDescending, double);
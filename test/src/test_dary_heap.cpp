@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/dary_heap.hpp>
+
+// Pushes and pops alternately, checking every top against
+// std::priority_queue
+template <size_t D, typename T, typename Compare>
+bool checkDaryHeapPushPop(size_t size) {
+  bool is_ok = true;
+  auto input = generateRandomVector<T>(size);
+
+  auto expect = std::priority_queue<T, std::vector<T>, Compare>();
+  auto actual = sorting::dary_heap<T, D, Compare>();
+  for (size_t i = 0; i < size; ++i) {
+    expect.push(input[i]);
+    actual.push(input[i]);
+    // Pop every third element, so that the heap both grows and shrinks
+    if (i % 3 == 2) {
+      ASSERT_EQ(expect.top(), actual.top());
+      expect.pop();
+      actual.pop();
+    }
+    ASSERT_EQ(expect.top(), actual.top());
+  }
+  while (!expect.empty()) {
+    ASSERT_EQ(expect.size(), actual.size());
+    ASSERT_EQ(expect.top(), actual.pop());
+    expect.pop();
+  }
+  ASSERT_EQ(true, actual.empty());
+  return is_ok;
+}
+
+template <typename Type> bool testDaryHeapPushPop(size_t input_size) {
+  using T = Type;
+  return checkDaryHeapPushPop<2, T, std::less<T>>(input_size) &&
+         checkDaryHeapPushPop<4, T, std::less<T>>(input_size) &&
+         checkDaryHeapPushPop<8, T, std::less<T>>(input_size) &&
+         checkDaryHeapPushPop<4, T, std::greater<T>>(input_size);
+}
+TestSort(DaryHeapPushPop, int8_t);
+TestSort(DaryHeapPushPop, int32_t);
+TestSort(DaryHeapPushPop, uint64_t);
+TestSort(DaryHeapPushPop, double);
+
+template <typename Type> bool testDaryHeapBuild(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect, std::greater<>());
+
+    auto heap = sorting::dary_heap<T>(input);
+    ASSERT_EQ(size, heap.size());
+    auto actual = std::vector<T>();
+    while (!heap.empty()) {
+      actual.push_back(heap.pop());
+    }
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(DaryHeapBuild, int8_t);
+TestSort(DaryHeapBuild, int32_t);
+TestSort(DaryHeapBuild, uint64_t);
+TestSort(DaryHeapBuild, double);
+
+// Keeps the k smallest elements with replace_top in reserved storage
+template <typename Type> bool testDaryHeapReplaceTop(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  const size_t k = size / 4 + 1;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+    expect.resize(std::min(k, size));
+
+    auto heap = sorting::dary_heap<T>();
+    heap.reserve(k);
+    const size_t capacity = heap.capacity();
+    for (const auto x : input) {
+      if (heap.size() < k) {
+        heap.push(x);
+      } else if (x < heap.top()) {
+        heap.replace_top(x);
+      }
+    }
+    ASSERT_EQ(capacity, heap.capacity());
+
+    auto actual = std::vector<T>(heap.size());
+    for (auto iter = actual.rbegin(); iter != actual.rend(); ++iter) {
+      *iter = heap.pop();
+    }
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(DaryHeapReplaceTop, int32_t);
+TestSort(DaryHeapReplaceTop, uint64_t);
+TestSortLarge(DaryHeapReplaceTop, int32_t);
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/external_sort.hpp>
+
+// A temp directory for the input and output files of one test, removed
+// afterwards
+struct TestDirectory {
+  std::filesystem::path path;
+
+  TestDirectory() {
+    path = std::filesystem::temp_directory_path() /
+           ("test_external_sort-" + std::to_string(std::random_device()()));
+    std::filesystem::create_directory(path);
+  }
+  ~TestDirectory() { std::filesystem::remove_all(path); }
+};
+
+template <typename T>
+void writeFile(const std::filesystem::path &path, const std::vector<T> &data) {
+  auto file = std::fopen(path.string().c_str(), "wb");
+  std::fwrite(data.data(), sizeof(T), data.size(), file);
+  std::fclose(file);
+}
+
+template <typename T>
+std::vector<T> readFile(const std::filesystem::path &path) {
+  auto data = std::vector<T>(std::filesystem::file_size(path) / sizeof(T));
+  auto file = std::fopen(path.string().c_str(), "rb");
+  std::fread(data.data(), sizeof(T), data.size(), file);
+  std::fclose(file);
+  return data;
+}
+
+// A budget of 64 records per run and merges of up to 3 runs, so that larger
+// inputs take several merge passes
+template <typename T> sorting::external_sort_options smallBudget() {
+  auto options = sorting::external_sort_options();
+  options.memory_budget = 128 * sizeof(T);
+  options.merge_buffer_size = 32 * sizeof(T);
+  return options;
+}
+
+template <typename Type> bool testExternalSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  const auto directory = TestDirectory();
+  const auto input = directory.path / "input";
+  const auto output = directory.path / "output";
+
+  auto data = generateRandomVector<T>(size);
+  writeFile(input, data);
+  std::ranges::sort(data);
+
+  auto options = smallBudget<T>();
+  options.temp_dir = directory.path;
+  auto stats = sorting::external_sort_stats();
+  sorting::external_sort<T>(input, output, options, &stats);
+  ASSERT_EQ(data, readFile<T>(output));
+
+  // Every record went through a run and the last pass, and the runs are gone
+  ASSERT_EQ(size, stats.record_count.load());
+  ASSERT_EQ(size, stats.run_record_count.load());
+  ASSERT_EQ(size, stats.merged_record_count.load());
+  ASSERT_EQ(size > 64, stats.run_count.load() > 0);
+  ASSERT_EQ(size > 64 * 3, stats.merge_pass_count.load() > 1);
+  ASSERT_EQ(size_t(2), size_t(std::ranges::distance(
+                           std::filesystem::directory_iterator(directory.path),
+                           std::filesystem::directory_iterator())));
+
+  // In place, with the default budget, which holds the input in one run
+  sorting::external_sort<T>(input, input);
+  ASSERT_EQ(data, readFile<T>(input));
+  return is_ok;
+}
+TestSort(ExternalSort, int32_t);
+TestSort(ExternalSort, uint64_t);
+TestSort(ExternalSort, double);
+TestSortLarge(ExternalSort, uint64_t);
+
+// Records with repeated keys, which must keep the order they came in
+struct ExternalRecord {
+  uint64_t key;
+  uint32_t index;
+
+  bool operator==(const ExternalRecord &) const = default;
+};
+
+bool testExternalSortStable(size_t input_size) {
+  bool is_ok = true;
+  const size_t size = input_size;
+  const auto directory = TestDirectory();
+  const auto input = directory.path / "input";
+  const auto output = directory.path / "output";
+
+  const auto keys = generateRandomVector<uint64_t>(size);
+  auto records = std::vector<ExternalRecord>(size);
+  for (size_t i = 0; i < size; ++i) {
+    records[i] = {keys[i / 8], static_cast<uint32_t>(i)};
+  }
+  std::ranges::shuffle(records, std::mt19937());
+  writeFile(input, records);
+  std::ranges::stable_sort(records, {}, &ExternalRecord::key);
+
+  sorting::external_sort<ExternalRecord>(input, output, &ExternalRecord::key,
+                                         smallBudget<ExternalRecord>());
+  ASSERT_EQ(true, records == readFile<ExternalRecord>(output));
+  return is_ok;
+}
+TestRegistrar registrar_testExternalSortStable("testExternalSortStable",
+                                               testExternalSortStable,
+                                               largeSizeParameter);
+
+bool testExternalSortErrors() {
+  bool is_ok = true;
+  const auto directory = TestDirectory();
+  const auto input = directory.path / "input";
+  const auto output = directory.path / "output";
+
+  bool is_thrown = false;
+  try {
+    sorting::external_sort<uint64_t>(input, output);
+  } catch (const std::filesystem::filesystem_error &) {
+    is_thrown = true;
+  }
+  ASSERT_EQ(true, is_thrown);
+
+  // Not a whole number of records
+  writeFile(input, std::vector<uint8_t>(12));
+  is_thrown = false;
+  try {
+    sorting::external_sort<uint64_t>(input, output);
+  } catch (const std::invalid_argument &) {
+    is_thrown = true;
+  }
+  ASSERT_EQ(true, is_thrown);
+
+  // A temp directory that does not exist
+  writeFile(input, generateRandomVector<uint64_t>(1024));
+  auto options = smallBudget<uint64_t>();
+  options.temp_dir = directory.path / "missing";
+  is_thrown = false;
+  try {
+    sorting::external_sort<uint64_t>(input, output, options);
+  } catch (const std::filesystem::filesystem_error &) {
+    is_thrown = true;
+  }
+  ASSERT_EQ(true, is_thrown);
+  return is_ok;
+}
+TestRegistrar registrar_testExternalSortErrors("testExternalSortErrors",
+                                               testExternalSortErrors);
@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
+#include <span>
 
 #include <test_sort_utility.hpp>
 
@@ -29,3 +31,60 @@ TestSort(HeapSort, int64_t);
 TestSort(HeapSort, uint8_t);
 TestSort(HeapSort, uint32_t);
 TestSort(HeapSort, uint64_t);
+TestSortLarge(HeapSort, int32_t);
+
+template <size_t Arity, typename T> bool testDaryHeapSort(size_t size) {
+  bool is_ok = true;
+  for (size_t _ = 0; _ < 10; ++_) {
+    // Sizes one off a full level leave the last node short of children
+    for (const size_t n : {size, size + 1, size + Arity - 1}) {
+      auto input = generateRandomVector<T>(n);
+
+      auto expect = input;
+      std::ranges::sort(expect);
+
+      auto actual = std::move(input);
+      sorting::heap_sort<Arity>(actual);
+
+      ASSERT_EQ(expect, actual);
+    }
+  }
+  return is_ok;
+}
+
+template <typename Type> bool testQuaternaryHeapSort(size_t input_size) {
+  return testDaryHeapSort<4, Type>(input_size);
+}
+TestSort(QuaternaryHeapSort, int8_t);
+TestSort(QuaternaryHeapSort, int32_t);
+TestSort(QuaternaryHeapSort, uint64_t);
+TestSort(QuaternaryHeapSort, double);
+
+template <typename Type> bool testOctonaryHeapSort(size_t input_size) {
+  return testDaryHeapSort<8, Type>(input_size);
+}
+TestSort(OctonaryHeapSort, int8_t);
+TestSort(OctonaryHeapSort, int32_t);
+TestSort(OctonaryHeapSort, uint64_t);
+TestSort(OctonaryHeapSort, double);
+
+template <typename Type> bool testHeapSortDescending(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect, std::greater<>());
+
+    auto actual = std::move(input);
+    sorting::heap_sort(std::span(actual), std::greater<>());
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(HeapSortDescending, int8_t);
+TestSort(HeapSortDescending, uint64_t);
+TestSort(HeapSortDescending, double);
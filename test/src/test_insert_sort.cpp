@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
+#include <span>
 
 #include <test_sort_utility.hpp>
 
@@ -28,4 +30,25 @@ TestSort(InsertSort, int32_t);
 TestSort(InsertSort, int64_t);
 TestSort(InsertSort, uint8_t);
 TestSort(InsertSort, uint32_t);
-TestSort(InsertSort, uint64_t);
\ No newline at end of file
+TestSort(InsertSort, uint64_t);
+
+template <typename Type> bool testInsertSortDescending(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect, std::greater<>());
+
+    auto actual = std::move(input);
+    sorting::insert_sort(std::span(actual), std::greater<>());
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(InsertSortDescending, int8_t);
+TestSort(InsertSortDescending, uint64_t);
+TestSort(InsertSortDescending, double);
@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
+#include <vector>
 
 #include <test_sort_utility.hpp>
 
@@ -28,4 +30,148 @@ TestSort(MergeSort, int32_t);
 TestSort(MergeSort, int64_t);
 TestSort(MergeSort, uint8_t);
 TestSort(MergeSort, uint32_t);
-TestSort(MergeSort, uint64_t);
\ No newline at end of file
+TestSort(MergeSort, uint64_t);
+
+template <typename Type> bool testMergeSortBuffer(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  // Reused across calls and longer than the input
+  auto buffer = std::vector<T>(2 * size);
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::merge_sort(actual, buffer);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(MergeSortBuffer, int8_t);
+TestSort(MergeSortBuffer, int32_t);
+TestSort(MergeSortBuffer, int64_t);
+TestSort(MergeSortBuffer, uint8_t);
+TestSort(MergeSortBuffer, uint32_t);
+TestSort(MergeSortBuffer, uint64_t);
+
+// Ordered by key only, so that equal keys show whether the order was kept
+template <typename Key> struct KeyedValue {
+  Key key;
+  size_t index;
+
+  bool operator<(const KeyedValue &other) const { return key < other.key; }
+  bool operator==(const KeyedValue &) const = default;
+};
+
+template <typename Type> bool testMergeSortStable(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto keys = generateRandomVector<T>(size);
+    auto input = std::vector<KeyedValue<T>>(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = {keys[i / 4], i};
+    }
+
+    auto expect = input;
+    std::stable_sort(expect.begin(), expect.end());
+
+    auto actual = std::move(input);
+    sorting::merge_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(MergeSortStable, int8_t);
+TestSort(MergeSortStable, uint64_t);
+TestSortLarge(MergeSortStable, int8_t);
+TestSortLarge(MergeSortStable, uint64_t);
+
+template <typename Type> bool testParallelMergeSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  // Shared by every run, as pools are meant to be reused
+  static auto pool = sorting::thread_pool(4);
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::parallel_merge_sort(actual, pool, 256);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(ParallelMergeSort, int8_t);
+TestSortLarge(ParallelMergeSort, int32_t);
+TestSortLarge(ParallelMergeSort, int64_t);
+TestSortLarge(ParallelMergeSort, uint8_t);
+TestSortLarge(ParallelMergeSort, uint32_t);
+TestSortLarge(ParallelMergeSort, uint64_t);
+
+template <typename Type> bool testParallelMergeSortStable(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  static auto pool = sorting::thread_pool(4);
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto keys = generateRandomVector<T>(size);
+    auto input = std::vector<KeyedValue<T>>(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = {keys[i / 4], i};
+    }
+
+    auto expect = input;
+    std::stable_sort(expect.begin(), expect.end());
+
+    auto actual = std::move(input);
+    sorting::parallel_merge_sort(actual, pool, 256);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(ParallelMergeSortStable, int8_t);
+TestSortLarge(ParallelMergeSortStable, uint64_t);
+
+// Sorts by the projected key in descending order, which must keep the order
+// of equal keys just as the default order does
+template <typename Type> bool testMergeSortProjection(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  static auto pool = sorting::thread_pool(4);
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto keys = generateRandomVector<T>(size);
+    auto input = std::vector<KeyedValue<T>>(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = {keys[i / 4], i};
+    }
+
+    auto expect = input;
+    std::ranges::stable_sort(expect, std::greater<>(), &KeyedValue<T>::key);
+
+    auto actual = input;
+    sorting::merge_sort(actual, std::greater<>(), &KeyedValue<T>::key);
+    ASSERT_EQ(expect, actual);
+
+    actual = input;
+    sorting::parallel_merge_sort(actual, pool, 256, std::greater<>(),
+                                 &KeyedValue<T>::key);
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(MergeSortProjection, int8_t);
+TestSort(MergeSortProjection, uint64_t);
+TestSortLarge(MergeSortProjection, int32_t);
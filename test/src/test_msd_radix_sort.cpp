@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/msd_radix_sort.hpp>
+
+template <typename Type> bool testMsdRadixSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::msd_radix_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(MsdRadixSort, int8_t);
+TestSort(MsdRadixSort, int32_t);
+TestSort(MsdRadixSort, int64_t);
+TestSort(MsdRadixSort, uint8_t);
+TestSort(MsdRadixSort, uint32_t);
+TestSort(MsdRadixSort, uint64_t);
+TestSort(MsdRadixSort, float);
+TestSort(MsdRadixSort, double);
+
+template <typename Type> bool testMsdRadixSortFewUnique(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 3; ++_) {
+    // Long runs of equal keys that share every digit
+    auto unique = generateRandomVector<T>(8);
+    auto input = generateRandomVector<T>(size);
+    for (auto &x : input) {
+      x = unique[static_cast<size_t>(x) % unique.size()];
+    }
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::msd_radix_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(MsdRadixSortFewUnique, int8_t);
+TestSortLarge(MsdRadixSortFewUnique, int32_t);
+TestSortLarge(MsdRadixSortFewUnique, int64_t);
+TestSortLarge(MsdRadixSortFewUnique, uint8_t);
+TestSortLarge(MsdRadixSortFewUnique, uint32_t);
+TestSortLarge(MsdRadixSortFewUnique, uint64_t);
+
+// Small buckets are sorted by radix key too, with or without the sorting
+// network, so -0.0 comes before 0.0 and NaNs go to the ends by their sign
+template <typename Type> bool testMsdRadixSortSpecialFloat(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  const auto nan = std::numeric_limits<T>::quiet_NaN();
+  const T special[] = {-0.0, 0.0, nan, -nan, 1.0, -1.0};
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+    for (size_t i = 0; i < size; i += 2) {
+      input[i] = special[i / 2 % std::size(special)];
+    }
+
+    auto expect = input;
+    sorting::radix_sort(expect);
+
+    auto actual = std::move(input);
+    sorting::msd_radix_sort(actual);
+
+    ASSERT_EQ(0, std::memcmp(expect.data(), actual.data(), size * sizeof(T)));
+  }
+  return is_ok;
+}
+TestSort(MsdRadixSortSpecialFloat, float);
+TestSort(MsdRadixSortSpecialFloat, double);
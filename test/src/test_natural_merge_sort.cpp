@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/natural_merge_sort.hpp>
+
+template <typename Type> bool testNaturalMergeSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::natural_merge_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(NaturalMergeSort, int8_t);
+TestSort(NaturalMergeSort, int32_t);
+TestSort(NaturalMergeSort, int64_t);
+TestSort(NaturalMergeSort, uint8_t);
+TestSort(NaturalMergeSort, uint32_t);
+TestSort(NaturalMergeSort, uint64_t);
+TestSortLarge(NaturalMergeSort, int8_t);
+TestSortLarge(NaturalMergeSort, uint64_t);
+
+// Ordered by key only and counting comparisons, so that equal keys show
+// whether the order was kept and presorted input shows whether it was noticed
+struct CountedKey {
+  static inline size_t comparison_count = 0;
+
+  int32_t key;
+  size_t index;
+
+  bool operator<(const CountedKey &other) const {
+    ++comparison_count;
+    return key < other.key;
+  }
+  bool operator==(const CountedKey &) const = default;
+};
+
+bool testNaturalMergeSortPatterns(size_t input_size) {
+  bool is_ok = true;
+  const size_t size = input_size;
+
+  // Few distinct keys, so that every pattern has long stretches of ties
+  auto keys = generateRandomVector<int32_t>(size);
+  for (auto &key : keys) {
+    key %= 16;
+  }
+  auto random = std::vector<CountedKey>(size);
+  for (size_t i = 0; i < size; ++i) {
+    random[i] = {keys[i], i};
+  }
+
+  auto sorted = random;
+  std::stable_sort(sorted.begin(), sorted.end());
+  auto reversed = sorted;
+  std::ranges::reverse(reversed);
+  auto nearly_sorted = sorted;
+  for (size_t i = 0; i + 7 < size; i += size / 8 + 1) {
+    std::swap(nearly_sorted[i], nearly_sorted[i + 7]);
+  }
+  auto organ_pipe = sorted;
+  std::reverse(organ_pipe.begin() + size / 2, organ_pipe.end());
+  auto appended = sorted;
+  std::copy(random.end() - size / 16, random.end(), appended.end() - size / 16);
+
+  for (auto input : {random, sorted, reversed, nearly_sorted, organ_pipe,
+                     appended}) {
+    auto expect = input;
+    std::stable_sort(expect.begin(), expect.end());
+
+    auto actual = input;
+    sorting::natural_merge_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+
+  // A sorted run is found with one comparison per element
+  auto actual = sorted;
+  CountedKey::comparison_count = 0;
+  sorting::natural_merge_sort(actual);
+  ASSERT_EQ(sorted, actual);
+  ASSERT_EQ(true, CountedKey::comparison_count < size);
+
+  // A strictly descending run is reversed just as cheaply
+  auto descending = std::vector<CountedKey>(size);
+  for (size_t i = 0; i < size; ++i) {
+    descending[i] = {static_cast<int32_t>(size - i), i};
+  }
+  auto expect = descending;
+  std::ranges::reverse(expect);
+  CountedKey::comparison_count = 0;
+  sorting::natural_merge_sort(descending);
+  ASSERT_EQ(expect, descending);
+  ASSERT_EQ(true, CountedKey::comparison_count < size);
+
+  return is_ok;
+}
+TestRegistrar registrar_testNaturalMergeSortPatterns(
+    "testNaturalMergeSortPatterns", testNaturalMergeSortPatterns,
+    largeSizeParameter);
+
+// Sorts by the projected key in descending order, in which an ascending run is
+// the one that needs reversing
+bool testNaturalMergeSortProjection(size_t input_size) {
+  bool is_ok = true;
+  const size_t size = input_size;
+
+  auto keys = generateRandomVector<int32_t>(size);
+  for (auto &key : keys) {
+    key %= 16;
+  }
+  auto random = std::vector<CountedKey>(size);
+  for (size_t i = 0; i < size; ++i) {
+    random[i] = {keys[i], i};
+  }
+
+  auto sorted = random;
+  std::stable_sort(sorted.begin(), sorted.end());
+  auto reversed = sorted;
+  std::ranges::reverse(reversed);
+
+  for (auto input : {random, sorted, reversed}) {
+    auto expect = input;
+    std::ranges::stable_sort(expect, std::greater<>(), &CountedKey::key);
+
+    auto actual = input;
+    sorting::natural_merge_sort(actual, std::greater<>(), &CountedKey::key);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestRegistrar registrar_testNaturalMergeSortProjection(
+    "testNaturalMergeSortProjection", testNaturalMergeSortProjection,
+    largeSizeParameter);
@@ -1,10 +1,15 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
 
 #include <test_sort_utility.hpp>
 
 #include <sorting-algorithm/quick_sort.hpp>
+#include <sorting-algorithm/simd_partition.hpp>
 
 template <typename Type> bool testQuickSort(size_t input_size) {
   bool is_ok = true;
@@ -29,3 +34,368 @@ TestSort(QuickSort, int64_t);
 TestSort(QuickSort, uint8_t);
 TestSort(QuickSort, uint32_t);
 TestSort(QuickSort, uint64_t);
+
+template <typename Type> bool testBlockQuickSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::quick_sort<sorting::partition_kernel::block>(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(BlockQuickSort, int8_t);
+TestSort(BlockQuickSort, int32_t);
+TestSort(BlockQuickSort, int64_t);
+TestSort(BlockQuickSort, uint8_t);
+TestSort(BlockQuickSort, uint32_t);
+TestSort(BlockQuickSort, uint64_t);
+TestSortLarge(BlockQuickSort, int8_t);
+TestSortLarge(BlockQuickSort, uint64_t);
+
+template <typename Type> bool testPdqQuickSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::quick_sort<sorting::partition_kernel::pdq>(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(PdqQuickSort, int8_t);
+TestSort(PdqQuickSort, int32_t);
+TestSort(PdqQuickSort, int64_t);
+TestSort(PdqQuickSort, uint8_t);
+TestSort(PdqQuickSort, uint32_t);
+TestSort(PdqQuickSort, uint64_t);
+TestSortLarge(PdqQuickSort, int8_t);
+TestSortLarge(PdqQuickSort, uint64_t);
+
+template <typename Type> bool testSimdQuickSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::quick_sort<sorting::partition_kernel::simd>(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(SimdQuickSort, int8_t);
+TestSort(SimdQuickSort, int32_t);
+TestSort(SimdQuickSort, int64_t);
+TestSort(SimdQuickSort, uint32_t);
+TestSort(SimdQuickSort, uint64_t);
+TestSort(SimdQuickSort, float);
+TestSortLarge(SimdQuickSort, int32_t);
+TestSortLarge(SimdQuickSort, uint32_t);
+TestSortLarge(SimdQuickSort, int64_t);
+TestSortLarge(SimdQuickSort, float);
+
+// Few distinct keys, so that most pivots are the least key of their range
+template <typename Type> bool testSimdQuickSortFewUnique(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto input = generateRandomVector<T>(size);
+    for (auto &value : input) {
+      value = static_cast<T>(value % 4);
+    }
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::quick_sort<sorting::partition_kernel::simd>(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(SimdQuickSortFewUnique, int32_t);
+TestSortLarge(SimdQuickSortFewUnique, uint32_t);
+TestSortLarge(SimdQuickSortFewUnique, int64_t);
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// Calls the AVX2 partition directly, since simd_partition only runs it on
+// CPUs without AVX-512. Pivots are taken from random keys and from few
+// distinct keys, which puts many keys equal to the pivot on either side.
+template <typename Type> bool testSimdPartitionAvx2(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  if (!__builtin_cpu_supports("avx2")) {
+    return is_ok;
+  }
+  const size_t size = input_size;
+
+  auto check = [&]<bool IsGreater>(std::vector<T> input) {
+    const T pivot = input[size / 2];
+    auto actual = input;
+    T *begin = actual.data();
+    T *end = begin + size;
+    T *middle = sorting::simd_partition_avx2<IsGreater>(begin, end, pivot);
+
+    const auto pivot_key = sorting::radix_key(pivot);
+    auto goes_right = [&](T x) {
+      return IsGreater ? sorting::radix_key(x) > pivot_key
+                       : sorting::radix_key(x) >= pivot_key;
+    };
+    const bool is_partitioned = std::none_of(begin, middle, goes_right) &&
+                                std::all_of(middle, end, goes_right);
+    std::ranges::sort(input);
+    std::ranges::sort(actual);
+    return is_partitioned && input == actual;
+  };
+
+  for (size_t _ = 0; _ < 10; ++_) {
+    const auto random = generateRandomVector<T>(size);
+    auto few_unique = random;
+    for (size_t i = 0; i < size; ++i) {
+      few_unique[i] = random[i % 4];
+    }
+    for (const auto &input : {random, few_unique}) {
+      ASSERT_EQ(true, check.template operator()<false>(input));
+      ASSERT_EQ(true, check.template operator()<true>(input));
+    }
+  }
+  return is_ok;
+}
+#define TestSimdPartitionAvx2(Type)                                            \
+  TestRegistrar registrar_testSimdPartitionAvx2##Type(                         \
+      "testSimdPartitionAvx2/" #Type, testSimdPartitionAvx2<Type>,             \
+      {sorting::sorting_network_max_size, 100, 1024, 65536});
+TestSimdPartitionAvx2(int32_t);
+TestSimdPartitionAvx2(uint32_t);
+TestSimdPartitionAvx2(int64_t);
+TestSimdPartitionAvx2(float);
+#endif
+
+// Sorted, reverse sorted, nearly sorted and organ pipe inputs
+template <sorting::partition_kernel Kernel>
+bool testQuickSortPatterns(size_t input_size) {
+  bool is_ok = true;
+  using T = int32_t;
+  const size_t size = input_size;
+
+  auto sorted = generateRandomVector<T>(size);
+  std::ranges::sort(sorted);
+  auto reversed = sorted;
+  std::ranges::reverse(reversed);
+  auto nearly_sorted = sorted;
+  for (size_t i = 0; i + 7 < size; i += size / 8 + 1) {
+    std::swap(nearly_sorted[i], nearly_sorted[i + 7]);
+  }
+  auto organ_pipe = sorted;
+  std::reverse(organ_pipe.begin() + size / 2, organ_pipe.end());
+
+  for (auto input : {sorted, reversed, nearly_sorted, organ_pipe}) {
+    auto actual = input;
+    sorting::quick_sort<Kernel>(actual);
+
+    ASSERT_EQ(sorted, actual);
+  }
+  return is_ok;
+}
+TestRegistrar registrar_testQuickSortPatternsThreeWay(
+    "testQuickSortPatterns/three_way",
+    testQuickSortPatterns<sorting::partition_kernel::three_way>,
+    largeSizeParameter);
+TestRegistrar registrar_testQuickSortPatternsBlock(
+    "testQuickSortPatterns/block",
+    testQuickSortPatterns<sorting::partition_kernel::block>,
+    largeSizeParameter);
+TestRegistrar registrar_testQuickSortPatternsPdq(
+    "testQuickSortPatterns/pdq",
+    testQuickSortPatterns<sorting::partition_kernel::pdq>, largeSizeParameter);
+TestRegistrar registrar_testQuickSortPatternsSimd(
+    "testQuickSortPatterns/simd",
+    testQuickSortPatterns<sorting::partition_kernel::simd>,
+    largeSizeParameter);
+
+// McIlroy's adversary ("A Killer Adversary for Quicksort"): every value starts
+// as gas and is frozen to the next solid value only when a comparison needs
+// it, which steers each pivot choice towards the worst one
+struct Adversary {
+  std::vector<size_t> values;
+  size_t solid_count = 0;
+  size_t candidate = 0;
+
+  bool isGas(size_t i) const { return values[i] == values.size(); }
+  void freeze(size_t i) { values[i] = solid_count++; }
+
+  bool less(size_t x, size_t y) {
+    if (isGas(x) && isGas(y)) {
+      freeze(x == candidate ? x : y);
+    }
+    if (isGas(x)) {
+      candidate = x;
+    } else if (isGas(y)) {
+      candidate = y;
+    }
+    return values[x] < values[y];
+  }
+};
+
+struct AdversaryIndex {
+  size_t index;
+  static Adversary *adversary;
+
+  bool operator<(const AdversaryIndex &other) const {
+    return adversary->less(index, other.index);
+  }
+};
+Adversary *AdversaryIndex::adversary = nullptr;
+
+struct CountedValue {
+  size_t value;
+  static size_t compare_count;
+
+  bool operator<(const CountedValue &other) const {
+    compare_count += 1;
+    return value < other.value;
+  }
+  bool operator==(const CountedValue &) const = default;
+};
+size_t CountedValue::compare_count = 0;
+
+template <sorting::partition_kernel Kernel>
+bool testQuickSortAdversary(size_t input_size) {
+  bool is_ok = true;
+  const size_t size = input_size;
+
+  // Let the adversary answer the comparisons of one run
+  auto adversary = Adversary{std::vector<size_t>(size, size)};
+  AdversaryIndex::adversary = &adversary;
+  auto indices = std::vector<AdversaryIndex>(size);
+  for (size_t i = 0; i < size; ++i) {
+    indices[i].index = i;
+  }
+  sorting::quick_sort<Kernel>(indices);
+
+  // Replay the input it built
+  auto input = std::vector<CountedValue>(size);
+  for (size_t i = 0; i < size; ++i) {
+    input[i].value = adversary.values[i];
+  }
+  auto expect = input;
+  std::sort(expect.begin(), expect.end());
+
+  CountedValue::compare_count = 0;
+  auto actual = std::move(input);
+  sorting::quick_sort<Kernel>(actual);
+
+  ASSERT_EQ(expect, actual);
+  const auto log_size = static_cast<size_t>(std::log2(size) + 1);
+  EXPECT_EQ(true, CountedValue::compare_count <= 8 * size * log_size);
+  return is_ok;
+}
+TestRegistrar registrar_testQuickSortAdversaryThreeWay(
+    "testQuickSortAdversary/three_way",
+    testQuickSortAdversary<sorting::partition_kernel::three_way>,
+    {1 << 10, 1 << 14});
+TestRegistrar registrar_testQuickSortAdversaryBlock(
+    "testQuickSortAdversary/block",
+    testQuickSortAdversary<sorting::partition_kernel::block>,
+    {1 << 10, 1 << 14});
+TestRegistrar registrar_testQuickSortAdversaryPdq(
+    "testQuickSortAdversary/pdq",
+    testQuickSortAdversary<sorting::partition_kernel::pdq>,
+    {1 << 10, 1 << 14});
+
+template <typename Type> bool testParallelQuickSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  // Shared by every run, as pools are meant to be reused
+  static auto pool = sorting::thread_pool(4);
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::parallel_quick_sort(actual, pool, 256);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(ParallelQuickSort, int8_t);
+TestSortLarge(ParallelQuickSort, int32_t);
+TestSortLarge(ParallelQuickSort, int64_t);
+TestSortLarge(ParallelQuickSort, uint8_t);
+TestSortLarge(ParallelQuickSort, uint32_t);
+TestSortLarge(ParallelQuickSort, uint64_t);
+
+// Descending order, given as a comparator and as a projection, on views of
+// the input; the simd kernel falls back to three_way for both
+template <sorting::partition_kernel Kernel>
+bool testQuickSortDescending(size_t input_size) {
+  bool is_ok = true;
+  using T = int32_t;
+  const size_t size = input_size;
+  static auto pool = sorting::thread_pool(4);
+
+  auto random = generateRandomVector<T>(size);
+  auto expect = random;
+  std::ranges::sort(expect, std::greater<>());
+  auto sorted = random;
+  std::ranges::sort(sorted);
+
+  for (auto input : {random, sorted}) {
+    auto actual = input;
+    sorting::quick_sort<Kernel>(std::span(actual), std::greater<>());
+    ASSERT_EQ(expect, actual);
+
+    actual = input;
+    sorting::quick_sort<Kernel>(std::span(actual), {},
+                                [](T x) { return -int64_t(x); });
+    ASSERT_EQ(expect, actual);
+  }
+
+  auto actual = random;
+  sorting::parallel_quick_sort(actual, pool, 256, std::greater<>());
+  ASSERT_EQ(expect, actual);
+  return is_ok;
+}
+TestRegistrar registrar_testQuickSortDescendingThreeWay(
+    "testQuickSortDescending/three_way",
+    testQuickSortDescending<sorting::partition_kernel::three_way>,
+    largeSizeParameter);
+TestRegistrar registrar_testQuickSortDescendingBlock(
+    "testQuickSortDescending/block",
+    testQuickSortDescending<sorting::partition_kernel::block>,
+    largeSizeParameter);
+TestRegistrar registrar_testQuickSortDescendingPdq(
+    "testQuickSortDescending/pdq",
+    testQuickSortDescending<sorting::partition_kernel::pdq>,
+    largeSizeParameter);
+TestRegistrar registrar_testQuickSortDescendingSimd(
+    "testQuickSortDescending/simd",
+    testQuickSortDescending<sorting::partition_kernel::simd>,
+    largeSizeParameter);
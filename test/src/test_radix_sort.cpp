@@ -1,7 +1,13 @@
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
 
 #include <test_sort_utility.hpp>
 
@@ -30,3 +36,268 @@ TestSort(RadixSort, int64_t);
 TestSort(RadixSort, uint8_t);
 TestSort(RadixSort, uint32_t);
 TestSort(RadixSort, uint64_t);
+TestSort(RadixSort, float);
+TestSort(RadixSort, double);
+
+template <typename Type> bool testRadixSortScratch(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  // Reused across calls and longer than the input
+  auto scratch = std::vector<T>(2 * size);
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::radix_sort(actual, scratch);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(RadixSortScratch, int8_t);
+TestSort(RadixSortScratch, int32_t);
+TestSort(RadixSortScratch, int64_t);
+TestSort(RadixSortScratch, uint8_t);
+TestSort(RadixSortScratch, uint32_t);
+TestSort(RadixSortScratch, uint64_t);
+TestSort(RadixSortScratch, float);
+TestSort(RadixSortScratch, double);
+
+template <typename Key> struct Record {
+  Key key;
+  uint32_t payload;
+
+  bool operator==(const Record &) const = default;
+};
+
+template <typename Type> bool testRadixSortProjection(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    // Few distinct keys, so that the payloads check stability
+    auto keys = generateRandomVector<T>(size);
+    auto input = std::vector<Record<T>>(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = {keys[i / 4], static_cast<uint32_t>(i)};
+    }
+
+    auto expect = input;
+    std::ranges::stable_sort(expect, {}, &Record<T>::key);
+
+    auto actual = std::move(input);
+    sorting::radix_sort(actual, &Record<T>::key);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(RadixSortProjection, int8_t);
+TestSort(RadixSortProjection, int32_t);
+TestSort(RadixSortProjection, int64_t);
+TestSort(RadixSortProjection, uint8_t);
+TestSort(RadixSortProjection, uint32_t);
+TestSort(RadixSortProjection, uint64_t);
+TestSort(RadixSortProjection, float);
+TestSort(RadixSortProjection, double);
+
+template <typename Type> bool testRadixSortNaN() {
+  bool is_ok = true;
+  using T = Type;
+  constexpr T inf = std::numeric_limits<T>::infinity();
+  constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+
+  auto actual =
+      std::vector<T>{T(1), -nan, T(0), inf, nan, T(-1), -inf, T(-0.0)};
+  sorting::radix_sort(actual);
+
+  ASSERT_EQ(true, std::isnan(actual[0]) && std::signbit(actual[0]));
+  EXPECT_EQ(-inf, actual[1]);
+  EXPECT_EQ(T(-1), actual[2]);
+  EXPECT_EQ(true, actual[3] == T(0) && std::signbit(actual[3]));
+  EXPECT_EQ(true, actual[4] == T(0) && !std::signbit(actual[4]));
+  EXPECT_EQ(T(1), actual[5]);
+  EXPECT_EQ(inf, actual[6]);
+  EXPECT_EQ(true, std::isnan(actual[7]) && !std::signbit(actual[7]));
+  return is_ok;
+}
+TestRegistrar registrar_testRadixSortNaNfloat("testRadixSortNaN/float",
+                                              testRadixSortNaN<float>);
+TestRegistrar registrar_testRadixSortNaNdouble("testRadixSortNaN/double",
+                                               testRadixSortNaN<double>);
+
+template <typename Type> bool testRadixSortDigitBit(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual3 = input;
+    sorting::radix_sort<3>(actual3);
+    EXPECT_EQ(expect, actual3);
+
+    auto actual11 = input;
+    sorting::radix_sort<11>(actual11);
+    EXPECT_EQ(expect, actual11);
+
+    auto actual16 = std::move(input);
+    sorting::radix_sort<16>(actual16);
+    EXPECT_EQ(expect, actual16);
+  }
+  return is_ok;
+}
+TestSort(RadixSortDigitBit, int8_t);
+TestSort(RadixSortDigitBit, int32_t);
+TestSort(RadixSortDigitBit, int64_t);
+TestSort(RadixSortDigitBit, uint8_t);
+TestSort(RadixSortDigitBit, uint32_t);
+TestSort(RadixSortDigitBit, uint64_t);
+TestSort(RadixSortDigitBit, float);
+TestSort(RadixSortDigitBit, double);
+
+template <typename Type> bool testRadixSortSkipPass(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    // Only the lowest byte varies, every higher digit is constant
+    auto input = generateRandomVector<T>(size);
+    for (auto &x : input) {
+      x = static_cast<T>((x & 0x7f) | 0x40);
+    }
+
+    auto expect = input;
+    std::ranges::sort(expect);
+    const size_t moved_pass_count = (expect.front() == expect.back()) ? 0 : 1;
+
+    auto stats = sorting::radix_sort_stats();
+    auto actual = std::move(input);
+    sorting::radix_sort<8>(actual, &stats);
+
+    ASSERT_EQ(expect, actual);
+    EXPECT_EQ(true, stats.pass_count >= sizeof(T));
+    EXPECT_EQ(stats.pass_count - moved_pass_count, stats.skipped_pass_count);
+  }
+  return is_ok;
+}
+TestSort(RadixSortSkipPass, int8_t);
+TestSort(RadixSortSkipPass, int32_t);
+TestSort(RadixSortSkipPass, int64_t);
+TestSort(RadixSortSkipPass, uint8_t);
+TestSort(RadixSortSkipPass, uint32_t);
+TestSort(RadixSortSkipPass, uint64_t);
+
+// Counts 8-bit and 11-bit digits of random keys and of keys with few
+// distinct values, at sizes on both sides of where the copies are used
+template <typename Type> bool testRadixCount(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  auto check = [&]<size_t BucketBit>(const std::vector<T> &input) {
+    constexpr size_t PassSize = (sizeof(T) * 8 + BucketBit - 1) / BucketBit;
+    constexpr size_t BucketSize = size_t(1) << BucketBit;
+    auto expect = std::vector<std::array<size_t, BucketSize>>(PassSize);
+    for (const auto x : input) {
+      for (size_t e = 0; e < PassSize; ++e) {
+        expect[e][(x >> (e * BucketBit)) & (BucketSize - 1)] += 1;
+      }
+    }
+
+    auto actual = std::vector<std::array<size_t, BucketSize>>(PassSize);
+    sorting::radix_count<BucketBit, PassSize>(
+        input.begin(), input.size(), std::identity(), actual);
+    return expect == actual;
+  };
+
+  for (const size_t n : {size, size * 64 + 3}) {
+    auto random = generateRandomVector<T>(n);
+    const auto values = generateRandomVector<T>(4);
+    auto few_unique = random;
+    for (auto &x : few_unique) {
+      x = values[static_cast<size_t>(x % 4)];
+    }
+    for (const auto &input : {random, few_unique}) {
+      ASSERT_EQ(true, check.template operator()<8>(input));
+      ASSERT_EQ(true, check.template operator()<11>(input));
+    }
+  }
+  return is_ok;
+}
+TestSort(RadixCount, uint32_t);
+TestSort(RadixCount, uint64_t);
+
+template <typename Type> bool testParallelRadixSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::parallel_radix_sort(actual, 4);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSortLarge(ParallelRadixSort, int8_t);
+TestSortLarge(ParallelRadixSort, int32_t);
+TestSortLarge(ParallelRadixSort, int64_t);
+TestSortLarge(ParallelRadixSort, uint8_t);
+TestSortLarge(ParallelRadixSort, uint32_t);
+TestSortLarge(ParallelRadixSort, uint64_t);
+TestSortLarge(ParallelRadixSort, float);
+TestSortLarge(ParallelRadixSort, double);
+
+// Scatters through the write-combining buffers at every size, into ranges
+// that start in the middle of a cache line too
+template <typename Type> bool testRadixSortWriteCombine(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  constexpr size_t Auto = sorting::radix_auto_digit_bit;
+  for (size_t _ = 0; _ < 3; ++_) {
+    auto input = generateRandomVector<T>(size + 1);
+    auto expect = input;
+    std::sort(expect.begin() + 1, expect.end());
+
+    auto actual = input;
+    auto unaligned = std::span(actual).subspan(1);
+    sorting::radix_sort<Auto, 0>(unaligned);
+    ASSERT_EQ(expect, actual);
+
+    actual = input;
+    sorting::radix_sort<11, 0>(unaligned);
+    ASSERT_EQ(expect, actual);
+
+    actual = input;
+    sorting::parallel_radix_sort<Auto, 0>(unaligned, 4);
+    ASSERT_EQ(expect, actual);
+
+    auto records = std::vector<Record<T>>(size);
+    for (size_t i = 0; i < size; ++i) {
+      records[i] = {input[i / 4], static_cast<uint32_t>(i)};
+    }
+    auto expect_records = records;
+    std::ranges::stable_sort(expect_records, {}, &Record<T>::key);
+    sorting::radix_sort<Auto, 0>(records, &Record<T>::key);
+    ASSERT_EQ(expect_records, records);
+  }
+  return is_ok;
+}
+TestSortLarge(RadixSortWriteCombine, int8_t);
+TestSortLarge(RadixSortWriteCombine, int32_t);
+TestSortLarge(RadixSortWriteCombine, uint64_t);
+TestSortLarge(RadixSortWriteCombine, float);
+TestSortLarge(RadixSortWriteCombine, double);
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/selection.hpp>
+
+// Positions to select at in a range of size elements
+std::vector<size_t> selectPositions(size_t size) {
+  return {0, size / 100, size / 2, size - size / 100 - 1, size - 1};
+}
+
+// Whether actual is a permutation of input with the element that sorting by
+// comp puts at nth there, and none on the wrong side of it
+template <typename T, typename Comp>
+bool isSelected(std::vector<T> input, std::vector<T> actual, size_t nth,
+                Comp comp) {
+  std::ranges::sort(input, comp);
+  const auto &x = actual[nth];
+  const bool is_partitioned =
+      std::all_of(actual.begin(), actual.begin() + nth,
+                  [&](const T &y) { return !comp(x, y); }) &&
+      std::all_of(actual.begin() + nth, actual.end(),
+                  [&](const T &y) { return !comp(y, x); });
+  std::ranges::sort(actual, comp);
+  return is_partitioned && input == actual;
+}
+
+template <typename Type> bool testNthElement(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto random = generateRandomVector<T>(size);
+    auto few_unique = random;
+    for (size_t i = 0; i < size; ++i) {
+      few_unique[i] = random[i % 4];
+    }
+    auto sorted = random;
+    std::ranges::sort(sorted);
+
+    for (const auto &input : {random, few_unique, sorted}) {
+      for (const auto nth : selectPositions(size)) {
+        auto actual = input;
+        sorting::nth_element(actual, actual.begin() + nth);
+        ASSERT_EQ(true, isSelected(input, actual, nth, std::less<>()));
+
+        actual = input;
+        sorting::nth_element(actual, actual.begin() + nth, std::greater<>());
+        ASSERT_EQ(true, isSelected(input, actual, nth, std::greater<>()));
+      }
+    }
+  }
+  return is_ok;
+}
+TestSort(NthElement, int8_t);
+TestSort(NthElement, int32_t);
+TestSort(NthElement, uint64_t);
+TestSort(NthElement, double);
+TestSortLarge(NthElement, int32_t);
+TestSortLarge(NthElement, uint64_t);
+TestSortLarge(NthElement, float);
+TestSortLarge(NthElement, double);
+
+// Introselect out of partitioning levels from the start, which leaves the
+// whole range to the heap
+bool testIntroselectHeapFallback(size_t input_size) {
+  bool is_ok = true;
+  const size_t size = input_size;
+  auto comp = std::less<>();
+  const auto input = generateRandomVector<int32_t>(size);
+  for (const auto nth : selectPositions(size)) {
+    auto actual = input;
+    sorting::introselect_impl(actual.begin(), actual.begin() + nth,
+                              actual.end(), 0, comp);
+    ASSERT_EQ(true, isSelected(input, actual, nth, comp));
+  }
+  return is_ok;
+}
+TestRegistrar registrar_testIntroselectHeapFallback(
+    "testIntroselectHeapFallback", testIntroselectHeapFallback, sizeParameter);
+
+template <typename Type> bool testPartialSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    const auto input = generateRandomVector<T>(size);
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    for (const auto count : {size_t(0), size_t(1), size / 100, size / 2,
+                             size}) {
+      auto actual = input;
+      sorting::partial_sort(actual, actual.begin() + count);
+      ASSERT_EQ(true, std::equal(expect.begin(), expect.begin() + count,
+                                 actual.begin()));
+      std::ranges::sort(actual);
+      ASSERT_EQ(expect, actual);
+    }
+  }
+  return is_ok;
+}
+TestSort(PartialSort, int8_t);
+TestSort(PartialSort, int32_t);
+TestSort(PartialSort, double);
+TestSortLarge(PartialSort, int32_t);
+TestSortLarge(PartialSort, double);
+
+// Selects the elements with the greatest keys, by projection, leaving the
+// input as it was
+template <typename Type> bool testTopK(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    const auto input = generateRandomVector<T>(size);
+    const auto copy = input;
+    auto expect = input;
+    std::ranges::sort(expect, std::greater<>());
+    // Reverses the order without overflowing on the least integer
+    auto negate = [](const T &x) -> T {
+      if constexpr (std::is_integral_v<T>) {
+        return ~x;
+      } else {
+        return -x;
+      }
+    };
+
+    for (const auto k : {size_t(0), size_t(1), size / 100, size / 2, size,
+                         size + 1}) {
+      const auto actual = sorting::top_k(input, k, std::greater<>());
+      ASSERT_EQ(std::min(k, size), actual.size());
+      ASSERT_EQ(true,
+                std::equal(actual.begin(), actual.end(), expect.begin()));
+
+      const auto projected = sorting::top_k(input, k, std::less<>(), negate);
+      ASSERT_EQ(true, std::ranges::equal(actual, projected));
+    }
+    ASSERT_EQ(copy, input);
+  }
+  return is_ok;
+}
+TestSort(TopK, int32_t);
+TestSort(TopK, double);
+TestSortLarge(TopK, int32_t);
+TestSortLarge(TopK, double);
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/sort.hpp>
+
+template <typename Type> bool testSort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto input = generateRandomVector<T>(size);
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = input;
+    sorting::sort(actual);
+    ASSERT_EQ(expect, actual);
+
+    std::ranges::reverse(expect);
+    actual = input;
+    sorting::sort(actual, std::greater<>());
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestSort(Sort, int8_t);
+TestSort(Sort, int32_t);
+TestSort(Sort, uint64_t);
+TestSort(Sort, double);
+TestSortLarge(Sort, int32_t);
+TestSortLarge(Sort, int64_t);
+TestSortLarge(Sort, uint64_t);
+TestSortLarge(Sort, float);
+TestSortLarge(Sort, double);
+
+// Sorts input with thresholds and returns the engine the sort reports,
+// checking the result against std::ranges::sort
+template <typename T, typename Comp = std::less<>>
+std::optional<sorting::sort_engine>
+sortEngine(std::vector<T> input, Comp comp = {},
+           const sorting::sort_thresholds &thresholds = {}) {
+  auto engine = std::optional<sorting::sort_engine>();
+  auto options = sorting::sort_options{thresholds};
+  options.report = [&](const sorting::sort_report &report) {
+    engine = report.engine;
+  };
+  auto expect = input;
+  std::ranges::sort(expect, comp);
+  sorting::sort(input, comp, std::identity(), options);
+  if (expect != input) {
+    return std::nullopt;
+  }
+  return engine;
+}
+
+// Inputs of the shapes each engine is picked for
+bool testSortEngine(size_t input_size) {
+  bool is_ok = true;
+  using enum sorting::sort_engine;
+  const size_t size = input_size;
+
+  auto random = generateRandomVector<int64_t>(size);
+  auto sorted = random;
+  std::ranges::sort(sorted);
+  auto reversed = sorted;
+  std::ranges::reverse(reversed);
+  auto few_unique = random;
+  for (auto &x : few_unique) {
+    x %= 4;
+  }
+  auto narrow = random;
+  for (auto &x : narrow) {
+    x &= (1 << 20) - 1;
+  }
+
+  ASSERT_EQ(insert_sort, sortEngine(std::vector<int64_t>(sorted.begin(),
+                                                         sorted.begin() + 8)));
+  ASSERT_EQ(natural_merge_sort, sortEngine(sorted));
+  ASSERT_EQ(natural_merge_sort, sortEngine(reversed));
+  ASSERT_EQ(natural_merge_sort, sortEngine(sorted, std::greater<>()));
+  ASSERT_EQ(radix_sort, sortEngine(generateRandomVector<double>(size)));
+  if (size >= sorting::sort_default_thresholds.radix_narrow_min_size) {
+    ASSERT_EQ(radix_sort, sortEngine(narrow));
+  }
+  ASSERT_EQ(pdq_quick_sort, sortEngine(random, std::greater<>()));
+
+  // Which quick sort depends on the CPU
+  const auto quick_sort = sorting::has_simd_partition<int64_t *>()
+                              ? simd_quick_sort
+                              : pdq_quick_sort;
+  ASSERT_EQ(quick_sort, sortEngine(few_unique));
+  if (quick_sort == simd_quick_sort) {
+    ASSERT_EQ(simd_quick_sort, sortEngine(random));
+  }
+
+  // Thresholds change the choice
+  auto thresholds = sorting::sort_default_thresholds;
+  thresholds.presorted_ratio = -1.0;
+  thresholds.radix_narrow_key_bit = 0;
+  ASSERT_EQ(quick_sort, sortEngine(sorted, std::less<>(), thresholds));
+  ASSERT_EQ(quick_sort, sortEngine(narrow, std::less<>(), thresholds));
+
+  return is_ok;
+}
+TestRegistrar registrar_testSortEngine("testSortEngine", testSortEngine,
+                                       largeSizeParameter);
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/sort_by_key.hpp>
+
+// The stable sorting permutation of keys, from std::stable_sort
+template <typename T, typename Comp = std::less<>>
+std::vector<uint32_t> stableArgsort(const std::vector<T> &keys,
+                                    Comp comp = {}) {
+  auto indices = std::vector<uint32_t>(keys.size());
+  std::iota(indices.begin(), indices.end(), uint32_t(0));
+  std::ranges::stable_sort(indices, comp,
+                           [&](uint32_t i) { return keys[i]; });
+  return indices;
+}
+
+template <typename Type> bool testArgsort(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    // Repeated keys, so that the indices show whether the order was kept
+    auto input = generateRandomVector<T>(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = input[i / 4];
+    }
+
+    ASSERT_EQ(stableArgsort(input), sorting::argsort(input));
+    ASSERT_EQ(stableArgsort(input, std::greater<>()),
+              sorting::argsort(input, std::greater<>()));
+    const auto wide = sorting::argsort<uint64_t>(input);
+    ASSERT_EQ(true, std::ranges::equal(stableArgsort(input), wide));
+  }
+  return is_ok;
+}
+TestSort(Argsort, int8_t);
+TestSort(Argsort, int32_t);
+TestSort(Argsort, uint64_t);
+TestSort(Argsort, double);
+TestSortLarge(Argsort, int32_t);
+TestSortLarge(Argsort, double);
+
+// Moves two payload columns along with the keys, one of which records where
+// each row came from
+template <typename Type> bool testSortByKey(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  const size_t size = input_size;
+  for (size_t _ = 0; _ < 10; ++_) {
+    auto keys = generateRandomVector<T>(size);
+    for (size_t i = 0; i < size; ++i) {
+      keys[i] = keys[i / 4];
+    }
+    auto rows = std::vector<size_t>(size);
+    std::iota(rows.begin(), rows.end(), size_t(0));
+    auto doubled = std::vector<double>(size);
+    for (size_t i = 0; i < size; ++i) {
+      doubled[i] = 2.0 * double(i);
+    }
+
+    const auto expect_rows = stableArgsort(keys);
+    auto expect_keys = keys;
+    std::ranges::stable_sort(expect_keys);
+
+    sorting::sort_by_key(keys, rows, doubled);
+
+    ASSERT_EQ(expect_keys, keys);
+    for (size_t i = 0; i < size; ++i) {
+      ASSERT_EQ(size_t(expect_rows[i]), rows[i]);
+      ASSERT_EQ(2.0 * double(rows[i]), doubled[i]);
+    }
+  }
+  return is_ok;
+}
+TestSort(SortByKey, int8_t);
+TestSort(SortByKey, int64_t);
+TestSort(SortByKey, uint32_t);
+TestSort(SortByKey, float);
+TestSortLarge(SortByKey, int64_t);
+TestSortLarge(SortByKey, float);
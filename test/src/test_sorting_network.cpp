@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <test_sort_utility.hpp>
+
+#include <sorting-algorithm/sorting_network.hpp>
+
+template <typename Type> bool testSortingNetwork(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  // Every size up to the largest block, so that every padding is covered
+  for (size_t size = 0; size <= input_size; ++size) {
+    for (size_t _ = 0; _ < 10; ++_) {
+      auto input = generateRandomVector<T>(size);
+
+      auto expect = input;
+      std::ranges::sort(expect);
+
+      auto actual = std::move(input);
+      sorting::sorting_network_sort(actual);
+
+      ASSERT_EQ(expect, actual);
+    }
+  }
+  return is_ok;
+}
+#define TestSortingNetwork(Type)                                               \
+  TestRegistrar registrar_testSortingNetwork##Type(                            \
+      "testSortingNetwork/" #Type, testSortingNetwork<Type>,                   \
+      {sorting::sorting_network_max_size});
+TestSortingNetwork(int32_t);
+TestSortingNetwork(uint32_t);
+TestSortingNetwork(int64_t);
+TestSortingNetwork(float);
+
+template <typename Type> bool testSortingNetworkFewUnique(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  for (size_t size = 0; size <= input_size; ++size) {
+    auto input = generateRandomVector<T>(size);
+    for (auto &value : input) {
+      value = static_cast<T>(static_cast<int64_t>(value) % 4);
+    }
+
+    auto expect = input;
+    std::ranges::sort(expect);
+
+    auto actual = std::move(input);
+    sorting::sorting_network_sort(actual);
+
+    ASSERT_EQ(expect, actual);
+  }
+  return is_ok;
+}
+TestRegistrar registrar_testSortingNetworkFewUniqueInt32(
+    "testSortingNetworkFewUnique/int32_t", testSortingNetworkFewUnique<int32_t>,
+    {sorting::sorting_network_max_size});
+TestRegistrar registrar_testSortingNetworkFewUniqueUInt32(
+    "testSortingNetworkFewUnique/uint32_t",
+    testSortingNetworkFewUnique<uint32_t>, {sorting::sorting_network_max_size});
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// Calls the SSE4.1 network directly, since sorting_network_sort only runs it
+// on CPUs without AVX2
+template <typename Type> bool testSortingNetworkSse41(size_t input_size) {
+  bool is_ok = true;
+  using T = Type;
+  if (!__builtin_cpu_supports("sse4.1")) {
+    return is_ok;
+  }
+  for (size_t size = 0; size <= input_size; ++size) {
+    for (size_t _ = 0; _ < 10; ++_) {
+      auto input = generateRandomVector<T>(size);
+      auto few_unique = input;
+      for (size_t i = 0; i < size; ++i) {
+        few_unique[i] = input[i % 4];
+      }
+
+      for (auto actual : {input, few_unique}) {
+        auto expect = actual;
+        std::ranges::sort(expect);
+        sorting::sorting_network_sort_sse41(actual.data(), size);
+        ASSERT_EQ(expect, actual);
+      }
+    }
+  }
+  return is_ok;
+}
+#define TestSortingNetworkSse41(Type)                                          \
+  TestRegistrar registrar_testSortingNetworkSse41##Type(                       \
+      "testSortingNetworkSse41/" #Type, testSortingNetworkSse41<Type>,         \
+      {sorting::sorting_network_max_size});
+TestSortingNetworkSse41(int32_t);
+TestSortingNetworkSse41(uint32_t);
+TestSortingNetworkSse41(float);
+#endif
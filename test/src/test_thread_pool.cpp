@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+
+#include <test_utility.hpp>
+
+#include <sorting-algorithm/thread_pool.hpp>
+
+// Spawns a binary tree of tasks of the given depth and counts its leaves
+void spawnTree(sorting::task_group &group, std::atomic<size_t> &leaf_count,
+               size_t depth) {
+  if (depth == 0) {
+    leaf_count += 1;
+    return;
+  }
+  group.run([&group, &leaf_count, depth] {
+    spawnTree(group, leaf_count, depth - 1);
+  });
+  spawnTree(group, leaf_count, depth - 1);
+}
+
+bool testTaskGroup(size_t num_threads) {
+  bool is_ok = true;
+  auto pool = sorting::thread_pool(num_threads);
+  for (size_t depth = 0; depth < 12; ++depth) {
+    auto leaf_count = std::atomic<size_t>(0);
+    auto group = sorting::task_group(pool);
+    spawnTree(group, leaf_count, depth);
+    group.wait();
+
+    EXPECT_EQ(size_t(1) << depth, leaf_count.load());
+  }
+  return is_ok;
+}
+TestRegistrar registrar_testTaskGroup("testTaskGroup", testTaskGroup,
+                                      {1, 2, 4, 8});
+
+// A task that throws still counts as finished: wait() returns and rethrows
+// the exception, and the group can be used again afterwards
+bool testTaskGroupException(size_t num_threads) {
+  bool is_ok = true;
+  auto pool = sorting::thread_pool(num_threads);
+  auto group = sorting::task_group(pool);
+  auto done_count = std::atomic<size_t>(0);
+  for (size_t i = 0; i < 64; ++i) {
+    group.run([&done_count, i] {
+      if (i % 8 == 3) {
+        throw std::runtime_error("task failed");
+      }
+      done_count += 1;
+    });
+  }
+
+  bool is_thrown = false;
+  try {
+    group.wait();
+  } catch (const std::runtime_error &) {
+    is_thrown = true;
+  }
+  EXPECT_EQ(true, is_thrown);
+  EXPECT_EQ(size_t(56), done_count.load());
+
+  group.run([&done_count] { done_count += 1; });
+  group.wait();
+  EXPECT_EQ(size_t(57), done_count.load());
+  return is_ok;
+}
+TestRegistrar registrar_testTaskGroupException("testTaskGroupException",
+                                               testTaskGroupException,
+                                               {1, 2, 4, 8});